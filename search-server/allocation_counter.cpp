@@ -0,0 +1,51 @@
+#include "allocation_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> allocation_count{0};
+
+}  // namespace
+
+// Замена глобального operator new вынесена в отдельный файл,
+// чтобы компилятор не встраивал её в код, который считает выделения
+void* operator new(size_t size) {
+    ++allocation_count;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// Через выровненную форму выделяет память std::pmr::new_delete_resource, поэтому она тоже считается
+void* operator new(size_t size, std::align_val_t alignment) {
+    ++allocation_count;
+    const size_t align = static_cast<size_t>(alignment);
+    // aligned_alloc требует размер, кратный выравниванию
+    if (void* ptr = std::aligned_alloc(align, (size == 0 ? align : size + align - 1) / align * align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, [[maybe_unused]] size_t size) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, [[maybe_unused]] std::align_val_t alignment) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, [[maybe_unused]] size_t size, [[maybe_unused]] std::align_val_t alignment) noexcept {
+    std::free(ptr);
+}
+
+size_t GetAllocationCount() {
+    return allocation_count.load();
+}
\ No newline at end of file
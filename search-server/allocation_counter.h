@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstddef>
+
+// Число обращений к operator new за время работы программы.
+// Глобальный operator new заменён в allocation_counter.cpp
+size_t GetAllocationCount();
\ No newline at end of file
@@ -0,0 +1,1468 @@
+#include "benchmark.h"
+#include "allocation_counter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <malloc.h>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "concurrent_search_server.h"
+#include "corpus_generator.h"
+#include "document.h"
+#include "index_allocation.h"
+#include "instrumentation.h"
+#include "log_duration.h"
+#include "paginator.h"
+#include "posting_list.h"
+#include "process_queries.h"
+#include "query_cache.h"
+#include "read_input_functions.h"
+#include "remove_duplicates.h"
+#include "request_queue.h"
+#include "scratch_arena.h"
+#include "search_pager.h"
+#include "search_server.h"
+#include "sharded_search_server.h"
+
+using namespace std::literals;
+
+std::string GenerateWord(std::mt19937& generator, int max_length) {
+    const int length = std::uniform_int_distribution(1, max_length)(generator);
+    std::string word;
+    word.reserve(length);
+    for (int i = 0; i < length; ++i) {
+        word.push_back(std::uniform_int_distribution('a', 'z')(generator));
+    }
+    return word;
+}
+
+std::vector<std::string> GenerateDictionary(std::mt19937& generator, int word_count, int max_length) {
+    std::vector<std::string> words;
+    words.reserve(word_count);
+    for (int i = 0; i < word_count; ++i) {
+        words.push_back(GenerateWord(generator, max_length));
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    return words;
+}
+
+std::string GenerateQuery(std::mt19937& generator, const std::vector<std::string>& dictionary, int word_count, double minus_prob) {
+    std::string query;
+    for (int i = 0; i < word_count; ++i) {
+        if (!query.empty()) {
+            query.push_back(' ');
+        }
+        if (std::uniform_real_distribution<>(0, 1)(generator) < minus_prob) {
+            query.push_back('-');
+        }
+        query += dictionary[std::uniform_int_distribution<int>(0, dictionary.size() - 1)(generator)];
+    }
+    return query;
+}
+
+std::vector<std::string> GenerateQueries(std::mt19937& generator, const std::vector<std::string>& dictionary, int query_count, int max_word_count) {
+    std::vector<std::string> queries;
+    queries.reserve(query_count);
+    for (int i = 0; i < query_count; ++i) {
+        queries.push_back(GenerateQuery(generator, dictionary, max_word_count));
+    }
+    return queries;
+}
+
+namespace {
+
+template <typename ExecutionPolicy>
+std::vector<std::vector<Document>> RunFindTopDocuments(const std::string& mark, const SearchServer& search_server,
+                                                       const std::vector<std::string>& queries, ExecutionPolicy&& policy) {
+    std::vector<std::vector<Document>> results;
+    results.reserve(queries.size());
+    LOG_DURATION(mark);
+    for (const std::string& query : queries) {
+        results.push_back(search_server.FindTopDocuments(policy, query));
+    }
+    return results;
+}
+
+template <typename ExecutionPolicy>
+int RunMatchDocument(const std::string& mark, const SearchServer& search_server,
+                     const std::string& query, ExecutionPolicy&& policy) {
+    LOG_DURATION(mark);
+    int word_count = 0;
+    for (int document_id = 0; document_id < search_server.GetDocumentCount(); ++document_id) {
+        const auto [words, status] = search_server.MatchDocument(policy, query, document_id);
+        word_count += words.size();
+    }
+    return word_count;
+}
+
+bool IsSameResult(const std::vector<std::vector<Document>>& lhs, const std::vector<std::vector<Document>>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (lhs[i].size() != rhs[i].size()) {
+            return false;
+        }
+        for (size_t j = 0; j < lhs[i].size(); ++j) {
+            if (lhs[i][j].id != rhs[i][j].id || lhs[i][j].rating != rhs[i][j].rating
+                || std::abs(lhs[i][j].relevance - rhs[i][j].relevance) > 1e-6) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void PrintThroughput(const std::string& mark, size_t document_count, size_t byte_count, std::chrono::steady_clock::duration duration) {
+    const double seconds = std::chrono::duration<double>(duration).count();
+    std::cout << mark << ": "s << static_cast<long long>(document_count / seconds) << " docs/s, "s
+              << byte_count / seconds / (1024 * 1024) << " MB/s"s << std::endl;
+}
+
+// Возвращает значение, не превышающее долю quantile выборки; порядок элементов меняется
+double ComputePercentile(std::vector<double>& values, double quantile) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const auto nth = values.begin() + static_cast<size_t>(quantile * (values.size() - 1));
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
+// Гоняет запросы в query_thread_count потоках, пока is_running() == true, и возвращает задержки в микросекундах
+template <typename IsRunning>
+std::vector<double> MeasureQueryLatencies(const ConcurrentSearchServer& search_server, const std::vector<std::string>& queries,
+                                          int query_thread_count, IsRunning is_running) {
+    std::vector<std::vector<double>> thread_latencies(query_thread_count);
+    std::vector<std::thread> threads;
+    for (int thread_index = 0; thread_index < query_thread_count; ++thread_index) {
+        threads.emplace_back([&, thread_index] {
+            for (size_t i = thread_index; is_running(); i += query_thread_count) {
+                const auto start = std::chrono::steady_clock::now();
+                search_server.FindTopDocuments(queries[i % queries.size()]);
+                thread_latencies[thread_index].push_back(
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    std::vector<double> latencies;
+    for (const std::vector<double>& part : thread_latencies) {
+        latencies.insert(latencies.end(), part.begin(), part.end());
+    }
+    return latencies;
+}
+
+// Состояние кучи glibc и резидентная память процесса в байтах
+struct HeapUsage {
+    size_t in_use = 0;
+    // Свободные участки внутри кучи, не возвращённые системе
+    size_t free = 0;
+    size_t resident = 0;
+};
+
+HeapUsage GetHeapUsage() {
+    const struct mallinfo2 info = mallinfo2();
+    HeapUsage usage;
+    usage.in_use = info.uordblks;
+    usage.free = info.fordblks;
+    std::ifstream statm("/proc/self/statm"s);
+    size_t total_pages = 0;
+    size_t resident_pages = 0;
+    statm >> total_pages >> resident_pages;
+    usage.resident = resident_pages * sysconf(_SC_PAGESIZE);
+    return usage;
+}
+
+double ToMegabytes(long long bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void PrintLatencies(const std::string& mark, std::vector<double> latencies) {
+    std::cout << mark << ": "s << latencies.size() << " queries, p50 "s << ComputePercentile(latencies, 0.5)
+              << " us, p99 "s << ComputePercentile(latencies, 0.99) << " us"s << std::endl;
+}
+
+}  // namespace
+
+void BenchmarkExecutionPolicies() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 1000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 10'000, 70);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+
+    std::vector<std::string> queries;
+    for (int i = 0; i < 100; ++i) {
+        queries.push_back(GenerateQuery(generator, dictionary, 50, 0.1));
+    }
+
+    const auto seq_results = RunFindTopDocuments("FindTopDocuments seq"s, search_server, queries, std::execution::seq);
+    const auto par_results = RunFindTopDocuments("FindTopDocuments par"s, search_server, queries, std::execution::par);
+    std::cout << "FindTopDocuments seq/par results "s << (IsSameResult(seq_results, par_results) ? "match"s : "DIFFER"s) << std::endl;
+    // Релевантность в параллельной версии складывается в том же порядке, поэтому совпадает до бита
+    bool identical = true;
+    for (size_t i = 0; i < seq_results.size(); ++i) {
+        identical = identical && std::equal(seq_results[i].begin(), seq_results[i].end(), par_results[i].begin(), par_results[i].end(),
+                                            [](const Document& lhs, const Document& rhs) {
+                                                return lhs.id == rhs.id && lhs.relevance == rhs.relevance;
+                                            });
+    }
+    std::cout << "FindTopDocuments seq/par relevance "s << (identical ? "identical"s : "DIFFER"s) << std::endl;
+
+    // Редкое слово есть только в последних документах, то есть в одном диапазоне порядковых номеров
+    SearchServer skewed_server(""s);
+    const int skewed_document_count = 100'000;
+    const int rare_document_count = 1'000;
+    for (int i = 0; i < skewed_document_count; ++i) {
+        skewed_server.AddDocument(i, i < skewed_document_count - rare_document_count ? "common word"s : "common rare"s,
+                                  DocumentStatus::ACTUAL, {i % 10});
+    }
+    const std::vector<std::string> skewed_queries = {"rare"s, "rare -common"s, "rare word"s};
+    const auto skewed_seq_results = RunFindTopDocuments("FindTopDocuments skewed seq"s, skewed_server, skewed_queries, std::execution::seq);
+    const auto skewed_par_results = RunFindTopDocuments("FindTopDocuments skewed par"s, skewed_server, skewed_queries, std::execution::par);
+    std::cout << "FindTopDocuments skewed seq/par results "s
+              << (IsSameResult(skewed_seq_results, skewed_par_results) ? "match"s : "DIFFER"s) << std::endl;
+
+    const std::string match_query = GenerateQuery(generator, dictionary, 50, 0.1);
+    const int seq_words = RunMatchDocument("MatchDocument seq"s, search_server, match_query, std::execution::seq);
+    const int par_words = RunMatchDocument("MatchDocument par"s, search_server, match_query, std::execution::par);
+    std::cout << "MatchDocument seq/par results "s << (seq_words == par_words ? "match"s : "DIFFER"s) << std::endl;
+}
+
+void BenchmarkProcessQueries() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 2000, 25);
+    const auto documents = GenerateQueries(generator, dictionary, 20'000, 10);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+
+    const auto queries = GenerateQueries(generator, dictionary, 2'000, 7);
+
+    std::vector<std::vector<Document>> loop_results;
+    {
+        LOG_DURATION("Sequential loop"s);
+        for (const std::string& query : queries) {
+            loop_results.push_back(search_server.FindTopDocuments(query));
+        }
+    }
+
+    std::vector<std::vector<Document>> batch_results;
+    {
+        LOG_DURATION("ProcessQueries"s);
+        batch_results = ProcessQueries(search_server, queries);
+    }
+    std::cout << "ProcessQueries results "s << (IsSameResult(loop_results, batch_results) ? "match"s : "DIFFER"s) << std::endl;
+
+    size_t total_documents = 0;
+    {
+        LOG_DURATION("ProcessQueriesJoined"s);
+        for ([[maybe_unused]] const Document& document : ProcessQueriesJoined(search_server, queries)) {
+            ++total_documents;
+        }
+    }
+    std::cout << "ProcessQueriesJoined documents: "s << total_documents << std::endl;
+
+    // Некорректный запрос посреди пакета не завершает программу, а выбрасывает исключение вызывающему
+    std::vector<std::string> invalid_queries(queries.begin(), queries.begin() + 100);
+    invalid_queries[50] = "dog --cat"s;
+    bool is_thrown = false;
+    try {
+        ProcessQueries(search_server, invalid_queries);
+    } catch (const std::invalid_argument&) {
+        is_thrown = true;
+    }
+    std::cout << "ProcessQueries invalid query "s << (is_thrown ? "rejected"s : "NOT REJECTED"s) << std::endl;
+}
+
+void BenchmarkQueryAllocations() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 2000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 10'000, 30);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+
+    std::vector<std::string> queries;
+    for (int i = 0; i < 1000; ++i) {
+        queries.push_back(GenerateQuery(generator, dictionary, 10, 0.2));
+    }
+
+    // Первый запрос прогревает переиспользуемый аккумулятор релевантности
+    size_t allocations = GetAllocationCount();
+    size_t found = search_server.FindTopDocuments(queries.front()).size();
+    allocations = GetAllocationCount() - allocations;
+    std::cout << "FindTopDocuments allocations in first query: "s << allocations << std::endl;
+
+    allocations = GetAllocationCount();
+    for (size_t i = 1; i < queries.size(); ++i) {
+        found += search_server.FindTopDocuments(queries[i]).size();
+    }
+    allocations = GetAllocationCount() - allocations;
+    std::cout << "FindTopDocuments allocations per query: "s
+              << static_cast<double>(allocations) / (queries.size() - 1) << std::endl;
+
+    size_t matched = 0;
+    allocations = GetAllocationCount();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        matched += std::get<0>(search_server.MatchDocument(queries[i], i)).size();
+    }
+    allocations = GetAllocationCount() - allocations;
+    std::cout << "MatchDocument allocations per query: "s
+              << static_cast<double>(allocations) / queries.size() << std::endl;
+    std::cout << "Found documents: "s << found << ", matched words: "s << matched << std::endl;
+}
+
+void BenchmarkIndexMemory() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 20'000, 10);
+
+    SearchServer search_server(dictionary[0]);
+    {
+        LOG_DURATION("Index 50000 documents"s);
+        for (int i = 0; i < 50'000; ++i) {
+            search_server.AddDocument(i, GenerateQuery(generator, dictionary, 30), DocumentStatus::ACTUAL, {1, 2, 3});
+        }
+    }
+
+    const SearchServer::IndexMemoryUsage usage = search_server.GetMemoryUsage();
+    std::cout << "Term dictionary: "s << usage.term_dictionary << " bytes"s << std::endl;
+    std::cout << "Inverted index: "s << usage.inverted_index << " bytes"s << std::endl;
+    std::cout << "Forward index: "s << usage.forward_index << " bytes"s << std::endl;
+    std::cout << "Documents: "s << usage.documents << " bytes"s << std::endl;
+    std::cout << "Total: "s << usage.Total() << " bytes"s << std::endl;
+}
+
+void BenchmarkPostingScan() {
+    const int posting_count = 1'000'000;
+    const int scan_count = 20;
+    const double idf = 0.5;
+
+    std::mt19937 generator;
+    std::map<int, double> map_postings;
+    PostingList list_postings;
+    for (int i = 0; i < posting_count; ++i) {
+        const int document_id = i * 3;
+        const double term_freq = std::uniform_real_distribution<>(0, 1)(generator);
+        map_postings.emplace(document_id, term_freq);
+        list_postings.Add(document_id, term_freq);
+    }
+
+    double map_sum = 0;
+    {
+        LOG_DURATION("Scan std::map postings"s);
+        for (int i = 0; i < scan_count; ++i) {
+            for (const auto [document_id, term_freq] : map_postings) {
+                map_sum += term_freq * idf + document_id % 2;
+            }
+        }
+    }
+
+    double list_sum = 0;
+    {
+        LOG_DURATION("Scan PostingList postings"s);
+        for (int i = 0; i < scan_count; ++i) {
+            list_postings.ForEachImpact(idf, [&list_sum](int document_id, double impact) {
+                list_sum += impact + document_id % 2;
+            });
+        }
+    }
+    std::cout << "Posting scan sums "s << (std::abs(map_sum - list_sum) < 1e-3 * map_sum ? "match"s : "DIFFER"s)
+              << ", "s << posting_count * scan_count << " postings per layout"s << std::endl;
+
+    std::vector<int> lookups(posting_count);
+    for (int& document_id : lookups) {
+        document_id = std::uniform_int_distribution(0, posting_count * 3)(generator);
+    }
+
+    int map_found = 0;
+    {
+        LOG_DURATION("Lookup std::map postings"s);
+        for (int document_id : lookups) {
+            map_found += map_postings.count(document_id);
+        }
+    }
+
+    int list_found = 0;
+    {
+        LOG_DURATION("Lookup PostingList postings"s);
+        for (int document_id : lookups) {
+            list_found += list_postings.Contains(document_id);
+        }
+    }
+    std::cout << "Posting lookups "s << (map_found == list_found ? "match"s : "DIFFER"s) << std::endl;
+}
+
+void BenchmarkTopDocuments() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 100, 6);
+    const auto documents = GenerateQueries(generator, dictionary, 100'000, 20);
+
+    SearchServer search_server("-"s);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {static_cast<int>(i % 10)});
+    }
+
+    const auto queries = GenerateQueries(generator, dictionary, 20, 2);
+
+    size_t top_count = 0;
+    {
+        LOG_DURATION("FindTopDocuments top 5"s);
+        for (const std::string& query : queries) {
+            top_count += search_server.FindTopDocuments(query).size();
+        }
+    }
+
+    size_t all_count = 0;
+    {
+        LOG_DURATION("FindTopDocuments sort all"s);
+        for (const std::string& query : queries) {
+            all_count += search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, documents.size()).size();
+        }
+    }
+    std::cout << "Top 5 documents: "s << top_count << ", all matched documents: "s << all_count << std::endl;
+}
+
+void BenchmarkMaxScore() {
+    std::mt19937 generator;
+
+    const auto rare_words = GenerateDictionary(generator, 20'000, 10);
+    const auto common_words = GenerateDictionary(generator, 20, 4);
+
+    // В каждом документе есть несколько частых слов, так что их списки покрывают почти весь корпус
+    SearchServer search_server("-"s);
+    for (int i = 0; i < 100'000; ++i) {
+        const std::string document = GenerateQuery(generator, rare_words, 15) + " "s + GenerateQuery(generator, common_words, 5);
+        search_server.AddDocument(i, document, DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    std::vector<std::string> queries;
+    for (int i = 0; i < 200; ++i) {
+        queries.push_back(GenerateQuery(generator, rare_words, 2) + " "s + GenerateQuery(generator, common_words, 3));
+    }
+
+    std::vector<std::vector<Document>> exhaustive_results;
+    {
+        LOG_DURATION("FindTopDocuments exhaustive"s);
+        for (const std::string& query : queries) {
+            exhaustive_results.push_back(search_server.FindTopDocuments(query));
+        }
+    }
+
+    std::vector<std::vector<Document>> max_score_results;
+    PruningStats stats;
+    {
+        LOG_DURATION("FindTopDocuments MaxScore"s);
+        for (const std::string& query : queries) {
+            max_score_results.push_back(search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, MAX_RESULT_DOCUMENT_COUNT,
+                                                                       QueryEvaluation::MAX_SCORE, &stats));
+        }
+    }
+    std::cout << "MaxScore results "s << (IsSameResult(exhaustive_results, max_score_results) ? "match"s : "DIFFER"s)
+              << ", postings visited: "s << stats.postings_visited << ", skipped: "s << stats.postings_skipped << std::endl;
+}
+
+void BenchmarkSnapshot() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 20'000, 10);
+    std::vector<std::string> documents;
+    for (int i = 0; i < 100'000; ++i) {
+        documents.push_back(GenerateQuery(generator, dictionary, 30));
+    }
+    const auto queries = GenerateQueries(generator, dictionary, 1'000, 5);
+
+    std::optional<SearchServer> built_server;
+    {
+        LOG_DURATION("Build index from documents"s);
+        built_server.emplace("-"s);
+        for (size_t i = 0; i < documents.size(); ++i) {
+            built_server->AddDocument(static_cast<int>(i), documents[i], DocumentStatus::ACTUAL, {static_cast<int>(i % 10)});
+        }
+    }
+    // Удалённые документы проверяют уплотнение порядковых номеров при записи
+    for (int i = 0; i < 100'000; i += 7) {
+        built_server->RemoveDocument(i);
+    }
+
+    const std::string path = (std::filesystem::temp_directory_path() / "search_server_benchmark.snapshot").string();
+    {
+        LOG_DURATION("SaveSnapshot"s);
+        built_server->SaveSnapshot(path);
+    }
+    std::cout << "Snapshot size: "s << std::filesystem::file_size(path) / (1024 * 1024) << " MB"s << std::endl;
+
+    std::optional<SearchServer> loaded_server;
+    {
+        LOG_DURATION("LoadSnapshot"s);
+        loaded_server.emplace(SearchServer::LoadSnapshot(path));
+    }
+
+    const auto built_results = RunFindTopDocuments("FindTopDocuments built index"s, *built_server, queries, std::execution::seq);
+    const auto loaded_results = RunFindTopDocuments("FindTopDocuments loaded snapshot"s, *loaded_server, queries, std::execution::seq);
+    std::cout << "Snapshot results "s << (IsSameResult(built_results, loaded_results) ? "match"s : "DIFFER"s) << std::endl;
+
+    loaded_server.reset();
+    std::filesystem::remove(path);
+}
+
+void BenchmarkBulkLoad() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 20'000, 10);
+    std::string input;
+    for (int i = 0; i < 100'000; ++i) {
+        const DocumentRecord record{i, static_cast<DocumentStatus>(i % 4), {i % 10, i % 7}, GenerateQuery(generator, dictionary, 50)};
+        input += FormatDocumentRecord(record);
+        input += '\n';
+    }
+    const auto queries = GenerateQueries(generator, dictionary, 1'000, 5);
+
+    SearchServer single_server("-"s);
+    {
+        std::istringstream stream(input);
+        size_t byte_count = 0;
+        const auto start = std::chrono::steady_clock::now();
+        size_t document_count = 0;
+        for (const DocumentRecord& record : ReadDocuments(stream, input.size(), &byte_count)) {
+            single_server.AddDocument(record.id, record.text, record.status, record.ratings);
+            ++document_count;
+        }
+        PrintThroughput("AddDocument one by one"s, document_count, byte_count, std::chrono::steady_clock::now() - start);
+    }
+
+    SearchServer bulk_server("-"s);
+    {
+        std::istringstream stream(input);
+        const auto start = std::chrono::steady_clock::now();
+        const SearchServer::BulkLoadStats stats = bulk_server.AddDocuments(stream);
+        PrintThroughput("AddDocuments from stream"s, stats.document_count, stats.byte_count, std::chrono::steady_clock::now() - start);
+    }
+
+    std::vector<std::vector<Document>> single_results;
+    std::vector<std::vector<Document>> bulk_results;
+    for (const std::string& query : queries) {
+        single_results.push_back(single_server.FindTopDocuments(query));
+        bulk_results.push_back(bulk_server.FindTopDocuments(query));
+    }
+    std::cout << "Bulk load results "s << (IsSameResult(single_results, bulk_results) ? "match"s : "DIFFER"s) << std::endl;
+}
+
+void BenchmarkConcurrentUpdates() {
+    std::mt19937 generator;
+
+    const int base_document_count = 50'000;
+    const int added_document_count = 20'000;
+    const int batch_size = 200;
+    const int query_thread_count = 2;
+
+    const auto dictionary = GenerateDictionary(generator, 20'000, 10);
+    std::vector<DocumentRecord> records;
+    for (int i = 0; i < base_document_count + added_document_count; ++i) {
+        records.push_back({i, DocumentStatus::ACTUAL, {i % 10}, GenerateQuery(generator, dictionary, 30)});
+    }
+    const auto queries = GenerateQueries(generator, dictionary, 1'000, 5);
+
+    SearchServer base("-"s);
+    base.AddDocuments(std::vector<DocumentRecord>(records.begin(), records.begin() + base_document_count));
+    ConcurrentSearchServer search_server(std::move(base));
+
+    std::atomic<size_t> issued_query_count = 0;
+    PrintLatencies("Queries without writes"s, MeasureQueryLatencies(search_server, queries, query_thread_count, [&issued_query_count] {
+        return issued_query_count++ < 4'000;
+    }));
+
+    // Писатель добавляет документы пакетами и удаляет каждый десятый документ основного индекса
+    std::atomic<bool> is_writing = true;
+    std::thread writer([&] {
+        const auto start = std::chrono::steady_clock::now();
+        for (int first = base_document_count; first < base_document_count + added_document_count; first += batch_size) {
+            search_server.AddDocuments(std::vector<DocumentRecord>(records.begin() + first, records.begin() + first + batch_size));
+            for (int document_id = first - base_document_count; document_id < first - base_document_count + batch_size; document_id += 10) {
+                search_server.RemoveDocument(document_id);
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Ingest while querying: "s << static_cast<long long>(added_document_count / seconds) << " docs/s"s << std::endl;
+        is_writing = false;
+    });
+    PrintLatencies("Queries during writes"s, MeasureQueryLatencies(search_server, queries, query_thread_count, [&is_writing] {
+        return is_writing.load();
+    }));
+    writer.join();
+    std::cout << "Generations published: "s << search_server.GetGeneration()->number
+              << ", segments: "s << search_server.GetGeneration()->segments.size()
+              << ", merges: "s << search_server.GetMergeCount() << std::endl;
+
+    SearchServer reference("-"s);
+    reference.AddDocuments(records);
+    for (int document_id = 0; document_id < added_document_count; document_id += 10) {
+        reference.RemoveDocument(document_id);
+    }
+    search_server.Compact();
+
+    std::vector<std::vector<Document>> reference_results;
+    std::vector<std::vector<Document>> concurrent_results;
+    for (const std::string& query : queries) {
+        reference_results.push_back(reference.FindTopDocuments(query));
+        concurrent_results.push_back(search_server.FindTopDocuments(query));
+    }
+    std::cout << "Concurrent server results "s << (IsSameResult(reference_results, concurrent_results) ? "match"s : "DIFFER"s)
+              << ", documents: "s << search_server.GetDocumentCount() << std::endl;
+
+    // Удалённые документы, которые слияние ещё не выбросило, не должны влиять на IDF
+    const std::vector<DocumentRecord> tombstone_records(records.begin(), records.begin() + 10'000);
+    SearchServer tombstone_base("-"s);
+    tombstone_base.AddDocuments(tombstone_records);
+    MergePolicy no_merges;
+    no_merges.max_removed_ratio = 1.0;
+    ConcurrentSearchServer tombstone_server(std::move(tombstone_base), no_merges);
+    SearchServer tombstone_reference("-"s);
+    tombstone_reference.AddDocuments(tombstone_records);
+    for (int document_id = 0; document_id < static_cast<int>(tombstone_records.size()); document_id += 3) {
+        tombstone_server.RemoveDocument(document_id);
+        tombstone_reference.RemoveDocument(document_id);
+    }
+    reference_results.clear();
+    concurrent_results.clear();
+    for (const std::string& query : queries) {
+        reference_results.push_back(tombstone_reference.FindTopDocuments(query));
+        concurrent_results.push_back(tombstone_server.FindTopDocuments(query));
+    }
+    std::cout << "Concurrent server results before merge "s << (IsSameResult(reference_results, concurrent_results) ? "match"s : "DIFFER"s)
+              << ", merges: "s << tombstone_server.GetMergeCount() << std::endl;
+}
+
+void BenchmarkRemoveDocuments() {
+    std::mt19937 generator;
+
+    // Частые слова дают длинные списки документов: удаление по одному сдвигает их целиком
+    const auto rare_words = GenerateDictionary(generator, 20'000, 10);
+    const auto common_words = GenerateDictionary(generator, 50, 4);
+    std::vector<std::string> documents;
+    for (int i = 0; i < 100'000; ++i) {
+        documents.push_back(GenerateQuery(generator, rare_words, 25) + " "s + GenerateQuery(generator, common_words, 5));
+    }
+    std::vector<int> removed_ids(documents.size());
+    std::iota(removed_ids.begin(), removed_ids.end(), 0);
+    std::shuffle(removed_ids.begin(), removed_ids.end(), generator);
+    removed_ids.resize(documents.size() / 2);
+    const std::set<int> removed_id_set(removed_ids.begin(), removed_ids.end());
+
+    SearchServer original("-"s);
+    SearchServer reference("-"s);
+    for (int i = 0; i < static_cast<int>(documents.size()); ++i) {
+        original.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+        if (removed_id_set.count(i) == 0) {
+            reference.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+        }
+    }
+    std::cout << "Index memory before removal: "s << original.GetMemoryUsage().Total() / (1024 * 1024) << " MB"s << std::endl;
+
+    SearchServer one_by_one = original;
+    {
+        LOG_DURATION("RemoveDocument one by one"s);
+        for (const int document_id : removed_ids) {
+            one_by_one.RemoveDocument(document_id);
+        }
+    }
+    SearchServer batch = original;
+    {
+        LOG_DURATION("RemoveDocuments batch"s);
+        batch.RemoveDocuments(removed_ids);
+    }
+    SearchServer parallel_batch = original;
+    {
+        LOG_DURATION("RemoveDocuments par batch"s);
+        parallel_batch.RemoveDocuments(std::execution::par, removed_ids);
+    }
+    std::cout << "Index memory after removal: "s << batch.GetMemoryUsage().Total() / (1024 * 1024) << " MB, rebuilt from scratch: "s
+              << reference.GetMemoryUsage().Total() / (1024 * 1024) << " MB"s << std::endl;
+
+    const auto queries = GenerateQueries(generator, rare_words, 500, 3);
+    std::vector<std::vector<Document>> reference_results;
+    for (const std::string& query : queries) {
+        reference_results.push_back(reference.FindTopDocuments(query + " "s + common_words[query.size() % common_words.size()]));
+    }
+    for (const auto& [mark, search_server] : {std::pair{"one by one"s, &one_by_one}, {"batch"s, &batch}, {"par batch"s, &parallel_batch}}) {
+        std::vector<std::vector<Document>> results;
+        for (const std::string& query : queries) {
+            results.push_back(search_server->FindTopDocuments(query + " "s + common_words[query.size() % common_words.size()]));
+        }
+        std::cout << "Results after "s << mark << " removal "s << (IsSameResult(reference_results, results) ? "match"s : "DIFFER"s) << std::endl;
+    }
+}
+
+
+void BenchmarkDuplicates() {
+    std::mt19937 generator;
+
+    // Каждый десятый документ — точный повтор более раннего с переставленными словами,
+    // ещё каждый десятый — почти повтор, в котором одно слово заменено
+    const int document_count = 1'000'000;
+    const int words_per_document = 10;
+    const auto dictionary = GenerateDictionary(generator, 50'000, 10);
+    std::vector<std::vector<std::string_view>> document_words;
+    document_words.reserve(document_count);
+    std::vector<DocumentRecord> records;
+    records.reserve(document_count);
+    int exact_count = 0;
+    int near_count = 0;
+    for (int i = 0; i < document_count; ++i) {
+        const int kind = i < 1'000 ? 9 : std::uniform_int_distribution(0, 9)(generator);
+        std::vector<std::string_view> words;
+        if (kind == 0 || kind == 1) {
+            words = document_words[std::uniform_int_distribution(0, i - 1)(generator)];
+            if (kind == 0) {
+                std::shuffle(words.begin(), words.end(), generator);
+                ++exact_count;
+            } else {
+                words[std::uniform_int_distribution(0, words_per_document - 1)(generator)] =
+                    dictionary[std::uniform_int_distribution<size_t>(0, dictionary.size() - 1)(generator)];
+                ++near_count;
+            }
+        }
+        if (kind > 1) {
+            words.clear();
+            for (int j = 0; j < words_per_document; ++j) {
+                words.push_back(dictionary[std::uniform_int_distribution<size_t>(0, dictionary.size() - 1)(generator)]);
+            }
+        }
+        std::string text;
+        for (std::string_view word : words) {
+            text += word;
+            text += ' ';
+        }
+        records.push_back({i, DocumentStatus::ACTUAL, {i % 10}, std::move(text)});
+        document_words.push_back(std::move(words));
+    }
+    document_words = {};
+
+    SearchServer search_server(""s);
+    search_server.AddDocuments(records);
+    records = {};
+    std::cout << "Documents: "s << search_server.GetDocumentCount() << ", injected exact duplicates: "s << exact_count
+              << ", near duplicates: "s << near_count << std::endl;
+
+    std::vector<int> set_duplicates;
+    {
+        LOG_DURATION("Duplicates via set of term sets"s);
+        std::set<std::vector<SearchServer::TermId>> unique_document_terms;
+        for (const int document_id : search_server) {
+            if (!unique_document_terms.insert(search_server.GetDocumentTermIds(document_id)).second) {
+                set_duplicates.push_back(document_id);
+            }
+        }
+    }
+    std::vector<int> duplicates;
+    {
+        LOG_DURATION("Duplicates via fingerprints"s);
+        duplicates = FindDuplicates(search_server);
+    }
+    std::vector<int> parallel_duplicates;
+    {
+        LOG_DURATION("Duplicates via fingerprints par"s);
+        parallel_duplicates = FindDuplicates(std::execution::par, search_server);
+    }
+    std::cout << "Exact duplicates found: "s << duplicates.size() << ", results "s
+              << (duplicates == set_duplicates && duplicates == parallel_duplicates ? "match"s : "DIFFER"s) << std::endl;
+
+    std::vector<int> near_duplicates;
+    {
+        LOG_DURATION("Near duplicates via MinHash LSH par"s);
+        near_duplicates = FindNearDuplicates(std::execution::par, search_server, 0.8);
+    }
+    std::cout << "Near duplicates found at similarity 0.8: "s << near_duplicates.size() << ", includes all exact: "s
+              << (std::includes(near_duplicates.begin(), near_duplicates.end(), duplicates.begin(), duplicates.end()) ? "yes"s : "NO"s)
+              << std::endl;
+}
+
+void BenchmarkQueryCache() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 20'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 50'000, 50);
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+
+    // Частоты запросов распределены по закону Ципфа; повтор запроса приходит с переставленными словами
+    const auto distinct_queries = GenerateQueries(generator, dictionary, 2'000, 5);
+    std::vector<double> weights;
+    for (size_t rank = 1; rank <= distinct_queries.size(); ++rank) {
+        weights.push_back(1.0 / rank);
+    }
+    std::discrete_distribution<size_t> query_distribution(weights.begin(), weights.end());
+    std::vector<std::string> requests;
+    for (int i = 0; i < 20'000; ++i) {
+        std::vector<std::string_view> words = SplitIntoWords(distinct_queries[query_distribution(generator)]);
+        std::shuffle(words.begin(), words.end(), generator);
+        std::string request;
+        for (std::string_view word : words) {
+            request += word;
+            request += ' ';
+        }
+        requests.push_back(std::move(request));
+    }
+
+    std::vector<std::vector<Document>> direct_results;
+    {
+        LOG_DURATION("FindTopDocuments without cache"s);
+        for (const std::string& request : requests) {
+            direct_results.push_back(search_server.FindTopDocuments(request));
+        }
+    }
+    QueryResultCache cache(search_server, 128 * 1024);
+    std::vector<std::vector<Document>> cached_results;
+    {
+        LOG_DURATION("FindTopDocuments with cache"s);
+        for (const std::string& request : requests) {
+            cached_results.push_back(cache.FindTopDocuments(request));
+        }
+    }
+    QueryCacheStats stats = cache.GetStats();
+    std::cout << "Query cache hits: "s << stats.hits << ", misses: "s << stats.misses << ", evictions: "s << stats.evictions
+              << ", rejections: "s << stats.rejections << ", entries: "s << stats.entry_count << ", memory: "s
+              << stats.memory_usage / 1024 << " KB"s << std::endl;
+    std::cout << "Cached results "s << (IsSameResult(direct_results, cached_results) ? "match"s : "DIFFER"s) << std::endl;
+
+    // Каждое изменение индекса сбрасывает кеш, и следующий поиск видит новые документы
+    direct_results.clear();
+    cached_results.clear();
+    for (size_t i = 0; i < 5'000; ++i) {
+        if (i % 1'000 == 0) {
+            search_server.AddDocument(documents.size() + i, requests[i], DocumentStatus::ACTUAL, {5});
+        }
+        if (i % 1'000 == 500) {
+            search_server.RemoveDocument(i);
+        }
+        direct_results.push_back(search_server.FindTopDocuments(requests[i]));
+        cached_results.push_back(cache.FindTopDocuments(requests[i]));
+    }
+    stats = cache.GetStats();
+    std::cout << "Cached results with index updates "s << (IsSameResult(direct_results, cached_results) ? "match"s : "DIFFER"s)
+              << ", invalidations: "s << stats.invalidations << std::endl;
+}
+
+void BenchmarkQueryProfile() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 20'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 50'000, 50);
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], static_cast<DocumentStatus>(i % 4), {static_cast<int>(i % 10)});
+    }
+    const auto queries = GenerateQueries(generator, dictionary, 2'000, 7);
+
+    std::vector<std::vector<Document>> reference_results;
+    {
+        LOG_DURATION("FindTopDocuments"s);
+        for (const std::string& query : queries) {
+            reference_results.push_back(search_server.FindTopDocuments(query));
+        }
+    }
+    for (const auto& [mark, source] : {std::pair{"document map"s, MetadataSource::DOCUMENT_MAP}, {"tables"s, MetadataSource::TABLES}}) {
+        QueryProfile profile;
+        std::vector<std::vector<Document>> results;
+        for (const std::string& query : queries) {
+            results.push_back(search_server.ProfileFindTopDocuments(query, DocumentStatus::ACTUAL, profile, source));
+        }
+        const auto per_query_us = [&queries](uint64_t ns) {
+            return static_cast<double>(ns) / 1000 / queries.size();
+        };
+        std::cout << "Query profile with "s << mark << ", us per query: IDF "s << per_query_us(profile.idf_ns)
+                  << ", metadata "s << per_query_us(profile.metadata_ns) << ", accumulation "s << per_query_us(profile.accumulation_ns)
+                  << ", results "s << (IsSameResult(reference_results, results) ? "match"s : "DIFFER"s) << std::endl;
+    }
+}
+
+void BenchmarkStatusFilters() {
+    std::mt19937 generator;
+
+    // Актуальна лишь 0,1% документов, неактуальны 4,9%, а остальные заблокированы или удалены
+    const auto dictionary = GenerateDictionary(generator, 2'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 200'000, 30);
+    SearchServer search_server("-"s);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const int kind = i % 1'000;
+        const DocumentStatus status = kind < 1 ? DocumentStatus::ACTUAL
+                                    : kind < 50 ? DocumentStatus::IRRELEVANT
+                                    : kind < 500 ? DocumentStatus::BANNED : DocumentStatus::REMOVED;
+        search_server.AddDocument(i, documents[i], status, {static_cast<int>(i % 10)});
+    }
+    const auto queries = GenerateQueries(generator, dictionary, 1'000, 5);
+
+    const auto run = [&queries](const std::string& mark, const auto& find) {
+        std::vector<std::vector<Document>> results;
+        results.reserve(queries.size());
+        LOG_DURATION(mark);
+        for (const std::string& query : queries) {
+            results.push_back(find(query));
+        }
+        return results;
+    };
+    const auto actual_predicate = run("ACTUAL via predicate"s, [&search_server](const std::string& query) {
+        return search_server.FindTopDocuments(query, [](int, DocumentStatus status, int) {
+            return status == DocumentStatus::ACTUAL;
+        });
+    });
+    const auto actual_filter = run("ACTUAL via StatusFilter"s, [&search_server](const std::string& query) {
+        return search_server.FindTopDocuments(query, StatusFilter<DocumentStatus::ACTUAL>{});
+    });
+    const auto irrelevant_predicate = run("IRRELEVANT via predicate"s, [&search_server](const std::string& query) {
+        return search_server.FindTopDocuments(query, [](int, DocumentStatus status, int) {
+            return status == DocumentStatus::IRRELEVANT;
+        });
+    });
+    const auto irrelevant_filter = run("IRRELEVANT via StatusFilter"s, [&search_server](const std::string& query) {
+        return search_server.FindTopDocuments(query, StatusFilter<DocumentStatus::IRRELEVANT>{});
+    });
+    const auto rating_predicate = run("Rating >= 9 via predicate"s, [&search_server](const std::string& query) {
+        return search_server.FindTopDocuments(query, [](int, DocumentStatus, int rating) {
+            return rating >= 9;
+        });
+    });
+    const auto rating_filter = run("Rating >= 9 via RatingAtLeast"s, [&search_server](const std::string& query) {
+        return search_server.FindTopDocuments(query, RatingAtLeast<9>{});
+    });
+    const bool is_same_status_result = IsSameResult(actual_predicate, actual_filter) && IsSameResult(irrelevant_predicate, irrelevant_filter);
+    std::cout << "Status filter results "s << (is_same_status_result ? "match"s : "DIFFER"s)
+              << ", rating filter results "s << (IsSameResult(rating_predicate, rating_filter) ? "match"s : "DIFFER"s) << std::endl;
+}
+
+void BenchmarkRequestQueue() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 20'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 50'000, 30);
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+    // Половина запросов из несуществующих слов, чтобы часть ответов была пустой
+    auto queries = GenerateQueries(generator, dictionary, 10'000, 3);
+    const auto missing_words = GenerateDictionary(generator, 1'000, 10);
+    for (size_t i = 0; i < queries.size(); i += 2) {
+        queries[i] = "zzz"s + missing_words[i % missing_words.size()];
+    }
+    int expected_no_result = 0;
+    for (const std::string& query : queries) {
+        expected_no_result += search_server.FindTopDocuments(query).empty();
+    }
+
+    const int thread_count = 4;
+    const int rounds = 1;
+    RequestQueue request_queue(search_server);
+    {
+        LOG_DURATION("RequestQueue AddFindRequest from 4 threads"s);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&] {
+                for (int round = 0; round < rounds; ++round) {
+                    for (const std::string& query : queries) {
+                        request_queue.AddFindRequest(query);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+    const RequestStats stats = request_queue.GetStats();
+    const uint64_t expected_requests = static_cast<uint64_t>(thread_count) * rounds * queries.size();
+    const int no_result_requests = request_queue.GetNoResultRequests();
+    std::cout << "Requests: "s << stats.request_count << ", without results: "s << no_result_requests
+              << " ("s << stats.no_result_rate * 100 << "%), average results: "s << stats.average_result_count << std::endl;
+    std::cout << "Latency p50: "s << stats.latency_p50.count() / 1000 << " us, p95: "s << stats.latency_p95.count() / 1000
+              << " us, p99: "s << stats.latency_p99.count() / 1000 << " us, max: "s << stats.latency_max.count() / 1000
+              << " us"s << std::endl;
+    std::cout << "Request counters "s
+              << (stats.request_count == expected_requests
+                      && no_result_requests == thread_count * rounds * expected_no_result ? "match"s : "DIFFER"s) << std::endl;
+
+    {
+        LOG_DURATION("GetNoResultRequests x 1000000"s);
+        int64_t checksum = 0;
+        for (int i = 0; i < 1'000'000; ++i) {
+            checksum += request_queue.GetNoResultRequests();
+        }
+        std::cout << "Checksum: "s << checksum << std::endl;
+    }
+
+    // Запросы старше окна перестают учитываться
+    RequestQueue short_queue(search_server, {200ms, 10});
+    for (const std::string& query : queries) {
+        short_queue.AddFindRequest(query);
+    }
+    const int before_expiry = short_queue.GetNoResultRequests();
+    std::this_thread::sleep_for(300ms);
+    std::cout << "Short window: "s << before_expiry << " requests without results, after expiry: "s
+              << short_queue.GetNoResultRequests() << std::endl;
+
+    // Потоки пишут с временем, которое проходит все корзины окна, так что сдвиги окна идут одновременно с записью.
+    // Всё записанное остаётся в окне, поэтому ни один запрос не должен потеряться
+    const int records_per_thread = 200'000;
+    RequestQueue sliding_queue(search_server, {1000s, 1000});
+    const auto start_time = RequestQueue::Clock::now();
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < records_per_thread; ++i) {
+                    const auto finish_time = start_time + std::chrono::milliseconds(static_cast<int64_t>(i) * 998'000 / records_per_thread);
+                    sliding_queue.RecordRequest((i + t) % 2, 1us, finish_time);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+    const RequestStats sliding_stats = sliding_queue.GetStats();
+    const uint64_t expected_records = static_cast<uint64_t>(thread_count) * records_per_thread;
+    std::cout << "Sliding window counters "s
+              << (sliding_stats.request_count == expected_records && sliding_stats.no_result_count == expected_records / 2
+                      && sliding_queue.GetNoResultRequests() == static_cast<int>(expected_records / 2) ? "match"s : "DIFFER"s)
+              << std::endl;
+
+    // Окно из 4 корзин: запись с отстающим временем попадает на корзины, которые другие потоки как раз обнуляют.
+    // Сумма окна не должна уходить в минус и в конце должна совпасть с корзинами
+    RequestQueue narrow_queue(search_server, {4000s, 4});
+    std::atomic<bool> negative_seen = false;
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < records_per_thread; ++i) {
+                    const int64_t seconds = static_cast<int64_t>(i) * 100'000 / records_per_thread - (i + t) % 7 * 1000;
+                    narrow_queue.RecordRequest(0, 1us, start_time + std::chrono::seconds(std::max<int64_t>(seconds, 0)));
+                    if (i % 64 == 0 && narrow_queue.GetNoResultRequests() < 0) {
+                        negative_seen = true;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+    const RequestStats narrow_stats = narrow_queue.GetStats();
+    std::cout << "Window totals under expiry "s
+              << (!negative_seen && narrow_stats.no_result_count == narrow_stats.request_count
+                      && narrow_queue.GetNoResultRequests() == static_cast<int>(narrow_stats.no_result_count) ? "match"s : "DIFFER"s)
+              << std::endl;
+}
+
+void BenchmarkInstrumentation() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 50'000, 70);
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+    std::vector<std::string> queries;
+    for (int i = 0; i < 5'000; ++i) {
+        queries.push_back(GenerateQuery(generator, dictionary, 7, 0.2));
+    }
+
+    ResetStageTimings();
+    size_t page_count = 0;
+    {
+        LOG_DURATION(IsInstrumentationEnabled() ? "Queries with stage timers"s : "Queries without stage timers"s);
+        for (const std::string& query : queries) {
+            const auto results = search_server.FindTopDocuments(query);
+            page_count += Paginate(results, 2).size();
+        }
+    }
+    std::cout << "Pages: "s << page_count << std::endl;
+    std::cout << DumpStageTimingsJson() << std::endl;
+    std::cout << DumpStageTimingsPrometheus();
+}
+
+void BenchmarkShardedSearch() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 50'000, 70);
+    std::vector<std::string> queries;
+    for (int i = 0; i < 2'000; ++i) {
+        queries.push_back(GenerateQuery(generator, dictionary, 7, 0.2));
+    }
+
+    SearchServer search_server(dictionary[0]);
+    ShardedSearchServer single_shard(dictionary[0], 1);
+    ShardedSearchServer sharded(dictionary[0], 4);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const auto status = static_cast<DocumentStatus>(i % 7 == 0 ? 1 : 0);
+        const std::vector<int> ratings = {static_cast<int>(i % 11) - 5, 3};
+        search_server.AddDocument(i, documents[i], status, ratings);
+        single_shard.AddDocument(i, documents[i], status, ratings);
+        sharded.AddDocument(i, documents[i], status, ratings);
+    }
+
+    // Релевантность сравнивается точно, без допуска: общий IDF должен давать те же самые числа
+    const auto count_differences = [](const std::vector<std::vector<Document>>& lhs, const std::vector<std::vector<Document>>& rhs) {
+        int differences = 0;
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            if (lhs[i].size() != rhs[i].size()) {
+                ++differences;
+                continue;
+            }
+            for (size_t j = 0; j < lhs[i].size(); ++j) {
+                if (lhs[i][j].id != rhs[i][j].id || lhs[i][j].relevance != rhs[i][j].relevance || lhs[i][j].rating != rhs[i][j].rating) {
+                    ++differences;
+                    break;
+                }
+            }
+        }
+        return differences;
+    };
+    const auto run_queries = [&queries](const std::string& name, const auto& server, DocumentStatus status) {
+        std::vector<std::vector<Document>> results;
+        results.reserve(queries.size());
+        LOG_DURATION(name);
+        for (const std::string& query : queries) {
+            results.push_back(server.FindTopDocuments(query, status));
+        }
+        return results;
+    };
+
+    for (const DocumentStatus status : {DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT}) {
+        const auto expected = run_queries("SearchServer"s, search_server, status);
+        const auto single_shard_results = run_queries("ShardedSearchServer, 1 shard"s, single_shard, status);
+        const auto sharded_results = run_queries("ShardedSearchServer, 4 shards"s, sharded, status);
+        std::cout << "Sharded results: 1 shard differs in "s << count_differences(expected, single_shard_results)
+                  << ", 4 shards differ in "s << count_differences(expected, sharded_results) << " queries"s << std::endl;
+    }
+
+    for (size_t i = 0; i < documents.size(); i += 3) {
+        search_server.RemoveDocument(i);
+        sharded.RemoveDocument(i);
+    }
+    int match_differences = 0;
+    for (size_t i = 0; i < 500; ++i) {
+        const int document_id = static_cast<int>(i * 97 % documents.size() / 3 * 3 + 1);
+        const auto [expected_words, expected_status] = search_server.MatchDocument(queries[i], document_id);
+        const auto [words, status] = sharded.MatchDocument(queries[i], document_id);
+        match_differences += expected_status != status
+            || !std::equal(expected_words.begin(), expected_words.end(), words.begin(), words.end());
+    }
+    const auto expected = run_queries("SearchServer after removal"s, search_server, DocumentStatus::ACTUAL);
+    const auto sharded_results = run_queries("ShardedSearchServer, 4 shards after removal"s, sharded, DocumentStatus::ACTUAL);
+    std::cout << "After removal: "s << sharded.GetDocumentCount() << " of "s << search_server.GetDocumentCount()
+              << " documents, results differ in "s << count_differences(expected, sharded_results)
+              << " queries, MatchDocument differs in "s << match_differences << std::endl;
+}
+
+void BenchmarkDeepPagination() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 100, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 100'000, 30);
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {static_cast<int>(i % 5)});
+    }
+    const std::string query = dictionary[1] + " "s + dictionary[2] + " "s + dictionary[3];
+    const size_t page_size = 10;
+    const size_t page_count = 300;
+
+    // Страница N берётся из первых (N + 1) * page_size результатов, отсортированных целиком
+    std::vector<Document> materialized;
+    {
+        LOG_DURATION("300 pages via FindTopDocuments((N + 1) * page_size)"s);
+        for (size_t page = 0; page < page_count; ++page) {
+            const auto results = search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, (page + 1) * page_size);
+            const auto range = Paginate(results, page_size).GetPage(page);
+            materialized.insert(materialized.end(), range.begin(), range.end());
+        }
+    }
+    std::vector<Document> paged;
+    {
+        LOG_DURATION("300 pages via SearchPager"s);
+        SearchPager pager(search_server, query, DocumentStatus::ACTUAL, page_size);
+        for (size_t page = 0; page < page_count; ++page) {
+            const auto results = pager.GetPage(page);
+            paged.insert(paged.end(), results.begin(), results.end());
+        }
+    }
+    const auto expected = search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, page_count * page_size);
+    std::cout << "Pages "s << (IsSameResult({expected}, {materialized}) && IsSameResult({expected}, {paged}) ? "match"s : "DIFFER"s)
+              << ", documents: "s << paged.size() << std::endl;
+
+    // Переход сразу на глубокую страницу, когда конец предыдущей неизвестен
+    const size_t deep_page = 2'000;
+    std::vector<Document> full_page;
+    {
+        LOG_DURATION("Page 2000 via full sort"s);
+        const auto results = search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, (deep_page + 1) * page_size);
+        const auto range = Paginate(results, page_size).GetPage(deep_page);
+        full_page.assign(range.begin(), range.end());
+    }
+    std::vector<Document> direct_page;
+    {
+        LOG_DURATION("Page 2000 via FindTopDocumentsPage"s);
+        direct_page = search_server.FindTopDocumentsPage(query, DocumentStatus::ACTUAL, deep_page, page_size);
+    }
+    std::cout << "Deep page "s << (IsSameResult({full_page}, {direct_page}) ? "match"s : "DIFFER"s)
+              << ", documents: "s << direct_page.size() << std::endl;
+}
+
+void BenchmarkIndexAllocation() {
+    std::mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 20'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 100'000, 20);
+    const auto queries = GenerateQueries(generator, dictionary, 1'000, 5);
+    const int initial_count = 50'000;
+
+    const std::string path = (std::filesystem::temp_directory_path() / "search_server_allocation.snapshot").string();
+    std::vector<std::vector<std::vector<Document>>> results;
+    for (const auto& [mark, allocation] : {std::pair{"heap"s, IndexAllocation::HEAP}, std::pair{"pooled"s, IndexAllocation::POOLED}}) {
+        // Память, освобождённая прошлым прогоном, возвращается системе, чтобы он не влиял на замер
+        malloc_trim(0);
+        const HeapUsage before = GetHeapUsage();
+        size_t allocations = GetAllocationCount();
+        SearchServer search_server("-"s, allocation);
+        {
+            LOG_DURATION("Add 50000 documents and churn 50000 more, "s + mark);
+            for (int i = 0; i < initial_count; ++i) {
+                search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+            }
+            // Самые старые документы заменяются новыми, как при обновлении индекса
+            for (int i = initial_count; i < static_cast<int>(documents.size()); ++i) {
+                search_server.RemoveDocument(i - initial_count);
+                search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+            }
+        }
+        allocations = GetAllocationCount() - allocations;
+        const HeapUsage after = GetHeapUsage();
+        std::cout << "Index allocation "s << mark << ": "s << allocations << " allocations, heap in use +"s
+                  << ToMegabytes(static_cast<long long>(after.in_use) - before.in_use) << " MB, free in heap "s
+                  << ToMegabytes(after.free) << " MB ("s << 100.0 * after.free / (after.in_use + after.free)
+                  << "% fragmentation), RSS +"s << ToMegabytes(static_cast<long long>(after.resident) - before.resident) << " MB"s
+                  << std::endl;
+        results.push_back(RunFindTopDocuments("FindTopDocuments "s + mark + " index"s, search_server, queries, std::execution::seq));
+        if (allocation == IndexAllocation::POOLED) {
+            search_server.SaveSnapshot(path);
+        }
+    }
+    std::cout << "Index allocation results "s << (IsSameResult(results[0], results[1]) ? "match"s : "DIFFER"s) << std::endl;
+
+    for (const auto& [mark, allocation] : {std::pair{"heap"s, IndexAllocation::HEAP}, std::pair{"monotonic"s, IndexAllocation::MONOTONIC}}) {
+        size_t allocations = GetAllocationCount();
+        std::optional<SearchServer> loaded_server;
+        {
+            LOG_DURATION("LoadSnapshot "s + mark);
+            loaded_server.emplace(SearchServer::LoadSnapshot(path, allocation));
+        }
+        allocations = GetAllocationCount() - allocations;
+        std::cout << "LoadSnapshot "s << mark << ": "s << allocations << " allocations"s << std::endl;
+        const auto loaded_results = RunFindTopDocuments("FindTopDocuments "s + mark + " snapshot"s, *loaded_server, queries, std::execution::seq);
+        std::cout << "Snapshot "s << mark << " results "s << (IsSameResult(results[1], loaded_results) ? "match"s : "DIFFER"s) << std::endl;
+    }
+    std::filesystem::remove(path);
+
+    const ScratchArenaStats stats = GetScratchArenaStats();
+    std::cout << "Scratch arena: "s << stats.resets << " resets, "s << stats.overflow_allocations << " overflow allocations, buffer "s
+              << stats.buffer_size << " bytes"s << std::endl;
+}
+
+void BenchmarkPostingCompression() {
+    CorpusOptions options;
+    options.document_count = 50'000;
+    CorpusGenerator corpus(options);
+    const auto documents = corpus.GenerateDocuments();
+    std::vector<std::string> queries;
+    for (int i = 0; i < 2'000; ++i) {
+        queries.push_back(corpus.GenerateQuery(4, 0.2));
+    }
+
+    SearchServer search_server(corpus.GetStopWords());
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(static_cast<int>(i), documents[i], DocumentStatus::ACTUAL, corpus.GenerateRatings());
+    }
+    size_t posting_count = 0;
+    for (const int document_id : search_server) {
+        posting_count += search_server.GetDocumentTermIds(document_id).size();
+    }
+
+    std::vector<std::vector<std::vector<Document>>> results;
+    for (const auto& [mark, format] : {std::pair{"plain"s, PostingFormat::PLAIN}, std::pair{"compressed"s, PostingFormat::COMPRESSED}}) {
+        {
+            LOG_DURATION("SetPostingFormat "s + mark);
+            search_server.SetPostingFormat(format);
+        }
+        const size_t inverted_index = search_server.GetMemoryUsage().inverted_index;
+        std::cout << "Inverted index "s << mark << ": "s << inverted_index << " bytes, "s
+                  << static_cast<double>(inverted_index) / posting_count << " bytes per posting"s << std::endl;
+
+        results.push_back(RunFindTopDocuments("FindTopDocuments "s + mark + " postings"s, search_server, queries, std::execution::seq));
+        std::vector<std::vector<Document>> pruned_results;
+        {
+            LOG_DURATION("FindTopDocuments MaxScore "s + mark + " postings"s);
+            for (const std::string& query : queries) {
+                pruned_results.push_back(search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, MAX_RESULT_DOCUMENT_COUNT,
+                                                                        QueryEvaluation::MAX_SCORE));
+            }
+        }
+        results.push_back(std::move(pruned_results));
+        std::vector<std::vector<Document>> matched_words(1);
+        {
+            LOG_DURATION("MatchDocument "s + mark + " postings"s);
+            for (size_t i = 0; i < queries.size(); ++i) {
+                matched_words[0].push_back({0, 0.0, static_cast<int>(std::get<0>(search_server.MatchDocument(queries[i], i * 7)).size())});
+            }
+        }
+        results.push_back(std::move(matched_words));
+    }
+    std::cout << "Compressed posting results "s
+              << (std::equal(results.begin(), results.begin() + 3, results.begin() + 3, IsSameResult) ? "match"s : "DIFFER"s) << std::endl;
+
+    // Скорость распаковки: полный обход списка термина, который встречается почти в каждом документе
+    const int list_size = 1'000'000;
+    const int scan_count = 20;
+    std::mt19937 generator;
+    PostingList plain_postings;
+    PostingList compressed_postings(PostingFormat::COMPRESSED);
+    int document_id = 0;
+    for (int i = 0; i < list_size; ++i) {
+        document_id += std::uniform_int_distribution(1, 4)(generator);
+        const double term_freq = std::uniform_int_distribution(1, 3)(generator) * 1.0 / std::uniform_int_distribution(10, 100)(generator);
+        plain_postings.Add(document_id, term_freq);
+        compressed_postings.Add(document_id, term_freq);
+    }
+    for (const auto& [mark, postings] : {std::pair{"plain"s, &plain_postings}, std::pair{"compressed"s, &compressed_postings}}) {
+        double sum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < scan_count; ++i) {
+            postings->ForEachImpact(0.5, [&sum](int document_id, double impact) {
+                sum += impact + document_id % 2;
+            });
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Posting scan "s << mark << ": "s << static_cast<double>(postings->GetMemoryUsage()) / list_size
+                  << " bytes per posting, "s << static_cast<long long>(list_size * scan_count / seconds) << " postings/s (sum "s
+                  << static_cast<long long>(sum) << ")"s << std::endl;
+    }
+}
+
+void BenchmarkMatchDocuments() {
+    CorpusOptions options;
+    options.document_count = 50'000;
+    CorpusGenerator corpus(options);
+    const auto documents = corpus.GenerateDocuments();
+    std::vector<std::string> queries;
+    for (int i = 0; i < 200; ++i) {
+        queries.push_back(corpus.GenerateQuery(10, 0.2));
+    }
+    SearchServer search_server(corpus.GetStopWords());
+    for (size_t i = 0; i < documents.size(); ++i) {
+        search_server.AddDocument(static_cast<int>(i), documents[i], DocumentStatus::ACTUAL, corpus.GenerateRatings());
+    }
+    std::vector<int> document_ids;
+    for (int document_id = 0; document_id < static_cast<int>(documents.size()); document_id += 10) {
+        document_ids.push_back(document_id);
+    }
+
+    // Найденные слова каждой пары (запрос, документ) подряд, документ без слов даёт пустой список
+    using MatchedWords = std::vector<std::vector<std::string_view>>;
+
+    // Ожидаемый результат считается по тексту документов, без индекса
+    MatchedWords expected;
+    const std::string stop_words_text = corpus.GetStopWords();
+    const std::vector<std::string_view> stop_word_list = SplitIntoWords(stop_words_text);
+    const std::set<std::string_view> stop_word_set(stop_word_list.begin(), stop_word_list.end());
+    for (const std::string& query : queries) {
+        std::set<std::string_view> plus_words;
+        std::set<std::string_view> minus_words;
+        for (std::string_view word : SplitIntoWords(query)) {
+            const bool is_minus = word[0] == '-';
+            if (is_minus) {
+                word.remove_prefix(1);
+            }
+            if (stop_word_set.count(word) == 0) {
+                (is_minus ? minus_words : plus_words).insert(word);
+            }
+        }
+        for (const int document_id : document_ids) {
+            const std::vector<std::string_view> document_words = SplitIntoWords(documents[document_id]);
+            const std::set<std::string_view> document_word_set(document_words.begin(), document_words.end());
+            std::vector<std::string_view>& words = expected.emplace_back();
+            if (std::none_of(minus_words.begin(), minus_words.end(), [&document_word_set](std::string_view word) {
+                    return document_word_set.count(word) > 0;
+                })) {
+                for (std::string_view word : plus_words) {
+                    if (document_word_set.count(word) > 0) {
+                        words.push_back(word);
+                    }
+                }
+            }
+        }
+    }
+
+    MatchedWords one_by_one;
+    {
+        LOG_DURATION("MatchDocument one by one"s);
+        for (const std::string& query : queries) {
+            for (const int document_id : document_ids) {
+                one_by_one.push_back(std::get<0>(search_server.MatchDocument(query, document_id)));
+            }
+        }
+    }
+    MatchedWords batch_seq;
+    {
+        LOG_DURATION("MatchDocuments seq"s);
+        for (const std::string& query : queries) {
+            for (auto& [words, status] : search_server.MatchDocuments(query, document_ids)) {
+                batch_seq.push_back(std::move(words));
+            }
+        }
+    }
+    MatchedWords batch_par;
+    {
+        LOG_DURATION("MatchDocuments par"s);
+        for (const std::string& query : queries) {
+            for (auto& [words, status] : search_server.MatchDocuments(std::execution::par, query, document_ids)) {
+                batch_par.push_back(std::move(words));
+            }
+        }
+    }
+    std::cout << queries.size() * document_ids.size() << " matches, results "s
+              << (one_by_one == expected && batch_seq == expected && batch_par == expected ? "match"s : "DIFFER"s) << std::endl;
+}
\ No newline at end of file
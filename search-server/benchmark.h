@@ -0,0 +1,107 @@
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+// Генераторы синтетического корпуса: одинаковое зерно даёт одинаковые документы и запросы
+std::string GenerateWord(std::mt19937& generator, int max_length);
+
+std::vector<std::string> GenerateDictionary(std::mt19937& generator, int word_count, int max_length);
+
+std::string GenerateQuery(std::mt19937& generator, const std::vector<std::string>& dictionary, int word_count, double minus_prob = 0);
+
+std::vector<std::string> GenerateQueries(std::mt19937& generator, const std::vector<std::string>& dictionary, int query_count, int max_word_count);
+
+// Сравнивает последовательную и параллельную версии FindTopDocuments и MatchDocument
+// на корпусе из 10000 документов и запросах из 50 слов
+void BenchmarkExecutionPolicies();
+
+// Сравнивает ProcessQueries и ProcessQueriesJoined с последовательным циклом по запросам
+// на корпусе из 20000 документов и 2000 запросах
+void BenchmarkProcessQueries();
+
+// Считает выделения памяти на один запрос FindTopDocuments и MatchDocument
+void BenchmarkQueryAllocations();
+
+// Печатает память, занимаемую каждой структурой индекса, на корпусе из 50000 документов
+void BenchmarkIndexMemory();
+
+// Сравнивает скорость обхода и поиска в списке документов термина
+// для std::map<int, double> и PostingList на 1000000 записей
+void BenchmarkPostingScan();
+
+// Сравнивает отбор 5 лучших документов с полной сортировкой всех найденных
+// на запросах из частых слов, которые встречаются почти в каждом документе
+void BenchmarkTopDocuments();
+
+// Сравнивает полный перебор и MaxScore на запросах из редких и частых слов
+void BenchmarkMaxScore();
+
+// Сравнивает время запуска: построение индекса из текстов и загрузку снимка на 100000 документов.
+// Проверяет, что после загрузки запросы возвращают те же результаты
+void BenchmarkSnapshot();
+
+// Сравнивает загрузку 100000 документов из потока по одному через AddDocument и пакетами через AddDocuments.
+// Печатает скорость в документах и мегабайтах в секунду
+void BenchmarkBulkLoad();
+
+// Нагрузочная проверка ConcurrentSearchServer: потоки запросов работают, пока писатель добавляет
+// и удаляет документы, а фоновый поток сливает сегменты. Печатает p50 и p99 задержки запросов
+// без записи и во время неё и проверяет, что после Compact результаты совпадают с индексом,
+// построенным последовательно
+void BenchmarkConcurrentUpdates();
+
+// Удаляет половину корпуса из 100000 документов по одному, пакетом и параллельным пакетом.
+// Проверяет, что результаты запросов совпадают с индексом, построенным только из оставшихся документов
+void BenchmarkRemoveDocuments();
+
+// Ищет точные повторы среди 1000000 документов перебором через множество наборов слов и по отпечаткам
+// (последовательно и параллельно), затем почти повторы через MinHash и LSH. Проверяет, что результаты совпадают
+void BenchmarkDuplicates();
+
+// Выполняет 20000 запросов с распределением Ципфа по 2000 различным запросам без кеша и через QueryResultCache,
+// затем чередует запросы с изменениями индекса. Печатает счётчики кеша и проверяет, что результаты совпадают
+void BenchmarkQueryCache();
+
+// Разбивает время 2000 запросов к 50000 документам на вычисление IDF, чтение статуса и рейтинга
+// и накопление релевантности: сначала с поиском документов в словаре, затем с таблицами по номерам
+void BenchmarkQueryProfile();
+
+// Сравнивает поиск с предикатом-лямбдой и с фильтрами StatusFilter и RatingAtLeast на 200000 документах,
+// из которых 95% заблокированы или удалены, и проверяет, что результаты совпадают
+void BenchmarkStatusFilters();
+
+// Четыре потока выполняют по 10000 запросов к 50000 документам через общий RequestQueue. Печатает долю пустых ответов
+// и перцентили латентности, проверяет счётчики и замеряет GetNoResultRequests. Затем проверяет,
+// что запросы выпадают из короткого окна по времени
+void BenchmarkRequestQueue();
+
+// Выполняет 5000 запросов к 50000 документам и печатает время этапов поиска в JSON и в формате Prometheus.
+// Если программа собрана без SEARCH_SERVER_INSTRUMENTATION, счётчики остаются нулевыми
+void BenchmarkInstrumentation();
+
+// Сравнивает SearchServer с ShardedSearchServer из одного и четырёх шардов на 50000 документах:
+// время 2000 запросов и число запросов, в которых выдача отличается хотя бы в одном бите релевантности.
+// Затем удаляет треть документов и сравнивает ещё раз, вместе с MatchDocument
+void BenchmarkShardedSearch();
+
+// Листает 300 страниц по 10 документов выдачи запроса к 100000 документам: через FindTopDocuments с растущим
+// max_count и через SearchPager. Затем открывает страницу 2000 сразу, с полной сортировкой и через FindTopDocumentsPage.
+// Проверяет, что страницы совпадают
+void BenchmarkDeepPagination();
+
+// Строит индекс из 50000 документов и заменяет их 50000 новыми по одному, со словарями документов в куче и в пулах.
+// Печатает число выделений памяти, прирост кучи и резидентной памяти, долю свободного места в куче.
+// Затем загружает снимок со словарями в куче и в монотонном ресурсе и печатает счётчики временной памяти запросов
+void BenchmarkIndexAllocation();
+
+// Переводит индекс 50000 документов корпуса с распределением Ципфа из обычных списков документов в сжатые.
+// Печатает байты на запись и время запросов в обоих форматах и проверяет, что результаты совпадают.
+// Затем замеряет скорость обхода списка из 1000000 записей в каждом формате
+void BenchmarkPostingCompression();
+
+// Сопоставляет 200 запросов с каждым десятым из 50000 документов: по одному через MatchDocument
+// и пакетами через MatchDocuments, последовательно и параллельно. Проверяет, что найденные слова
+// совпадают с посчитанными по тексту документов
+void BenchmarkMatchDocuments();
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "concurrent_search_server.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+int ConcurrentSearchServer::Segment::GetLiveDocumentCount() const {
+    return index->GetDocumentCount() - static_cast<int>(removed->size());
+}
+
+int ConcurrentSearchServer::Generation::GetDocumentCount() const {
+    int document_count = buffer->GetDocumentCount();
+    for (const Segment& segment : segments) {
+        document_count += segment.GetLiveDocumentCount();
+    }
+    return document_count;
+}
+
+bool ConcurrentSearchServer::Generation::HasDocument(int document_id) const {
+    return buffer->HasDocument(document_id)
+        || std::any_of(segments.begin(), segments.end(), [document_id](const Segment& segment) {
+               return segment.index->HasDocument(document_id) && segment.removed->count(document_id) == 0;
+           });
+}
+
+std::vector<Document> ConcurrentSearchServer::Generation::FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                                                           size_t max_count) const {
+    return FindTopDocuments(
+        raw_query, [status]([[maybe_unused]] int document_id, DocumentStatus document_status, [[maybe_unused]] int rating) {
+            return document_status == status;
+        }, max_count);
+}
+
+ConcurrentSearchServer::ConcurrentSearchServer(SearchServer base, MergePolicy merge_policy)
+    : merge_policy_(merge_policy) {
+    auto empty_buffer = std::make_shared<const SearchServer>(base.GetStopWords());
+    std::vector<Segment> segments;
+    if (base.GetDocumentCount() > 0) {
+        segments.push_back({std::make_shared<const SearchServer>(std::move(base)), std::make_shared<const std::set<int>>()});
+    }
+    generation_ = std::make_shared<const Generation>(Generation{0, std::move(segments), std::move(empty_buffer)});
+    merge_thread_ = std::thread(&ConcurrentSearchServer::RunBackgroundMerges, this);
+}
+
+ConcurrentSearchServer::~ConcurrentSearchServer() {
+    {
+        std::lock_guard guard(write_mutex_);
+        is_stopping_ = true;
+    }
+    merge_needed_.notify_all();
+    merge_thread_.join();
+}
+
+std::shared_ptr<const ConcurrentSearchServer::Generation> ConcurrentSearchServer::GetGeneration() const {
+    return std::atomic_load(&generation_);
+}
+
+std::vector<Document> ConcurrentSearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status, size_t max_count) const {
+    return GetGeneration()->FindTopDocuments(raw_query, status, max_count);
+}
+
+int ConcurrentSearchServer::GetDocumentCount() const {
+    return GetGeneration()->GetDocumentCount();
+}
+
+void ConcurrentSearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    std::lock_guard guard(write_mutex_);
+    const auto generation = GetGeneration();
+    if (generation->HasDocument(document_id)) {
+        throw std::invalid_argument("Некорректный id документа"s);
+    }
+    // Копируется только небольшой изменяемый сегмент; неизменяемые остаются общими для поколений
+    SearchServer buffer = *generation->buffer;
+    buffer.AddDocument(document_id, document, status, ratings);
+    PublishBuffer(*generation, std::move(buffer));
+}
+
+void ConcurrentSearchServer::AddDocuments(const std::vector<DocumentRecord>& records) {
+    std::lock_guard guard(write_mutex_);
+    const auto generation = GetGeneration();
+    for (const DocumentRecord& record : records) {
+        if (generation->HasDocument(record.id)) {
+            throw std::invalid_argument("Некорректный id документа"s);
+        }
+    }
+    SearchServer buffer = *generation->buffer;
+    buffer.AddDocuments(records);
+    PublishBuffer(*generation, std::move(buffer));
+}
+
+void ConcurrentSearchServer::RemoveDocument(int document_id) {
+    std::lock_guard guard(write_mutex_);
+    const auto generation = GetGeneration();
+    if (generation->buffer->HasDocument(document_id)) {
+        SearchServer buffer = *generation->buffer;
+        buffer.RemoveDocument(document_id);
+        Publish(generation->segments, std::make_shared<const SearchServer>(std::move(buffer)));
+        return;
+    }
+    for (size_t i = 0; i < generation->segments.size(); ++i) {
+        const Segment& segment = generation->segments[i];
+        if (segment.index->HasDocument(document_id) && segment.removed->count(document_id) == 0) {
+            auto removed = std::make_shared<std::set<int>>(*segment.removed);
+            removed->insert(document_id);
+            std::vector<Segment> segments = generation->segments;
+            segments[i].removed = std::move(removed);
+            Publish(std::move(segments), generation->buffer);
+            merge_needed_.notify_one();
+            return;
+        }
+    }
+}
+
+void ConcurrentSearchServer::Compact() {
+    std::lock_guard merge_guard(merge_mutex_);
+    std::shared_ptr<const Generation> generation;
+    {
+        std::lock_guard guard(write_mutex_);
+        generation = GetGeneration();
+        if (generation->buffer->GetDocumentCount() > 0) {
+            std::vector<Segment> segments = generation->segments;
+            segments.push_back({generation->buffer, std::make_shared<const std::set<int>>()});
+            Publish(std::move(segments), std::make_shared<const SearchServer>(generation->buffer->GetStopWords()));
+            generation = GetGeneration();
+        }
+    }
+    const bool has_removed = std::any_of(generation->segments.begin(), generation->segments.end(), [](const Segment& segment) {
+        return !segment.removed->empty();
+    });
+    if (generation->segments.size() > 1 || has_removed) {
+        std::vector<size_t> segment_indexes(generation->segments.size());
+        for (size_t i = 0; i < segment_indexes.size(); ++i) {
+            segment_indexes[i] = i;
+        }
+        MergeSegments(*generation, segment_indexes);
+    }
+}
+
+uint64_t ConcurrentSearchServer::GetMergeCount() const {
+    std::lock_guard guard(write_mutex_);
+    return merge_count_;
+}
+
+void ConcurrentSearchServer::Publish(std::vector<Segment> segments, std::shared_ptr<const SearchServer> buffer) {
+    const uint64_t number = GetGeneration()->number + 1;
+    std::atomic_store(&generation_, std::make_shared<const Generation>(Generation{number, std::move(segments), std::move(buffer)}));
+}
+
+void ConcurrentSearchServer::PublishBuffer(const Generation& generation, SearchServer buffer) {
+    if (static_cast<size_t>(buffer.GetDocumentCount()) < merge_policy_.max_buffered_documents) {
+        Publish(generation.segments, std::make_shared<const SearchServer>(std::move(buffer)));
+        return;
+    }
+    std::vector<Segment> segments = generation.segments;
+    auto empty_buffer = std::make_shared<const SearchServer>(buffer.GetStopWords());
+    segments.push_back({std::make_shared<const SearchServer>(std::move(buffer)), std::make_shared<const std::set<int>>()});
+    Publish(std::move(segments), std::move(empty_buffer));
+    merge_needed_.notify_one();
+}
+
+std::vector<size_t> ConcurrentSearchServer::SelectMerge(const Generation& generation) const {
+    // Уровень сегмента — сколько раз его размер больше заполненного буфера в merge_factor раз.
+    // Сливаются только сегменты одного уровня, так что каждый документ переписывается O(log N) раз
+    const size_t merge_factor = std::max<size_t>(merge_policy_.merge_factor, 2);
+    std::map<int, std::vector<size_t>> tiers;
+    for (size_t i = 0; i < generation.segments.size(); ++i) {
+        const size_t live_document_count = std::max(generation.segments[i].GetLiveDocumentCount(), 0);
+        int tier = 0;
+        for (size_t tier_size = merge_policy_.max_buffered_documents * merge_factor; live_document_count >= tier_size;
+             tier_size *= merge_factor) {
+            ++tier;
+        }
+        tiers[tier].push_back(i);
+    }
+    for (auto& [tier, segment_indexes] : tiers) {
+        if (segment_indexes.size() >= merge_factor) {
+            segment_indexes.resize(merge_factor);
+            return segment_indexes;
+        }
+    }
+
+    for (size_t i = 0; i < generation.segments.size(); ++i) {
+        const Segment& segment = generation.segments[i];
+        if (segment.removed->size() > merge_policy_.max_removed_ratio * segment.index->GetDocumentCount()) {
+            return {i};
+        }
+    }
+    return {};
+}
+
+void ConcurrentSearchServer::MergeSegments(const Generation& generation, const std::vector<size_t>& segment_indexes) {
+    // Самая долгая часть идёт без write_mutex_: писатели и запросы в это время не ждут
+    SearchServer merged(generation.buffer->GetStopWords());
+    for (const size_t i : segment_indexes) {
+        merged.MergeFrom(*generation.segments[i].index, *generation.segments[i].removed);
+    }
+    auto merged_index = std::make_shared<const SearchServer>(std::move(merged));
+
+    std::lock_guard guard(write_mutex_);
+    const auto current = GetGeneration();
+    // Документы, удалённые из сливаемых сегментов во время слияния, становятся пометками нового сегмента
+    auto removed = std::make_shared<std::set<int>>();
+    std::vector<Segment> segments;
+    bool is_merged_placed = false;
+    for (const Segment& segment : current->segments) {
+        const auto merged_it = std::find_if(segment_indexes.begin(), segment_indexes.end(), [&](size_t i) {
+            return generation.segments[i].index == segment.index;
+        });
+        if (merged_it == segment_indexes.end()) {
+            segments.push_back(segment);
+            continue;
+        }
+        const std::set<int>& removed_before_merge = *generation.segments[*merged_it].removed;
+        for (const int document_id : *segment.removed) {
+            if (removed_before_merge.count(document_id) == 0) {
+                removed->insert(document_id);
+            }
+        }
+        if (!is_merged_placed && merged_index->GetDocumentCount() > 0) {
+            segments.push_back({merged_index, removed});
+        }
+        is_merged_placed = true;
+    }
+    ++merge_count_;
+    Publish(std::move(segments), current->buffer);
+}
+
+void ConcurrentSearchServer::RunBackgroundMerges() {
+    while (true) {
+        {
+            std::unique_lock lock(write_mutex_);
+            merge_needed_.wait(lock, [this] {
+                return is_stopping_ || !SelectMerge(*GetGeneration()).empty();
+            });
+            if (is_stopping_) {
+                return;
+            }
+        }
+        // Пока поток ждал merge_mutex_, Compact мог уже слить эти сегменты, поэтому выбор повторяется
+        std::lock_guard merge_guard(merge_mutex_);
+        const auto generation = GetGeneration();
+        const std::vector<size_t> segment_indexes = SelectMerge(*generation);
+        if (!segment_indexes.empty()) {
+            MergeSegments(*generation, segment_indexes);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "document.h"
+#include "read_input_functions.h"
+#include "search_server.h"
+#include "top_documents.h"
+
+// Пороги слияния сегментов
+struct MergePolicy {
+    // Столько документов копится в изменяемом сегменте, прежде чем он станет неизменяемым
+    size_t max_buffered_documents = 1'024;
+    // Столько сегментов одного уровня размера сливаются в один
+    size_t merge_factor = 8;
+    // Сегмент переписывается без удалённых документов, когда их доля превышает порог
+    double max_removed_ratio = 0.3;
+};
+
+// Поисковый сервер из неизменяемых сегментов и небольшого изменяемого сегмента в памяти.
+// Запрос берёт текущее поколение индекса и дальше работает только с ним, не блокируя писателей.
+// Писатель собирает новое поколение рядом со старым и публикует его атомарной заменой shared_ptr;
+// старое поколение освобождается, когда его отпустит последний запрос.
+// Удаление из неизменяемого сегмента только помечает документ, а фоновый поток сливает
+// сегменты по MergePolicy и выбрасывает помеченные документы
+class ConcurrentSearchServer {
+public:
+    // Неизменяемый сегмент и id его документов, удалённых после того, как он был создан
+    struct Segment {
+        std::shared_ptr<const SearchServer> index;
+        std::shared_ptr<const std::set<int>> removed;
+
+        int GetLiveDocumentCount() const;
+    };
+
+    // Неизменяемый срез индекса. Удалённые, но ещё не выброшенные слиянием документы
+    // в IDF не учитываются, поэтому релевантность та же, что у единого индекса после удаления
+    struct Generation {
+        uint64_t number = 0;
+        std::vector<Segment> segments;
+        // Изменяемый сегмент; каждое изменение публикуется как его новая копия
+        std::shared_ptr<const SearchServer> buffer;
+
+        int GetDocumentCount() const;
+
+        bool HasDocument(int document_id) const;
+
+        // Запрос выполняется в каждом сегменте, лучшие документы сегментов сливаются в общий топ
+        template <typename DocumentPredicate>
+        std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+                                               size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+        std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL,
+                                               size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+    };
+
+    explicit ConcurrentSearchServer(SearchServer base, MergePolicy merge_policy = MergePolicy());
+
+    ConcurrentSearchServer(const ConcurrentSearchServer&) = delete;
+    ConcurrentSearchServer& operator=(const ConcurrentSearchServer&) = delete;
+
+    // Дожидается окончания текущего фонового слияния
+    ~ConcurrentSearchServer();
+
+    std::shared_ptr<const Generation> GetGeneration() const;
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const {
+        return GetGeneration()->FindTopDocuments(raw_query, document_predicate, max_count);
+    }
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    int GetDocumentCount() const;
+
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    // Весь пакет становится виден запросам одновременно, в одном поколении
+    void AddDocuments(const std::vector<DocumentRecord>& records);
+
+    void RemoveDocument(int document_id);
+
+    // Сливает все сегменты, включая изменяемый, в один и выбрасывает удалённые документы
+    void Compact();
+
+    // Число слияний, выполненных в фоне и через Compact
+    uint64_t GetMergeCount() const;
+
+private:
+    const MergePolicy merge_policy_;
+    // Писатели выполняются по одному; читатели этот мьютекс не берут
+    mutable std::mutex write_mutex_;
+    std::shared_ptr<const Generation> generation_;
+    // Слияние сегментов одновременно выполняет только один поток: фоновый или вызвавший Compact
+    std::mutex merge_mutex_;
+    std::condition_variable merge_needed_;
+    bool is_stopping_ = false;
+    uint64_t merge_count_ = 0;
+    std::thread merge_thread_;
+
+    // Публикует поколение со следующим номером; вызывается под write_mutex_
+    void Publish(std::vector<Segment> segments, std::shared_ptr<const SearchServer> buffer);
+
+    // Переводит заполненный изменяемый сегмент в неизменяемые и будит фоновое слияние
+    void PublishBuffer(const Generation& generation, SearchServer buffer);
+
+    // Номера сегментов, которые пора слить, или пустой вектор
+    std::vector<size_t> SelectMerge(const Generation& generation) const;
+
+    // Сливает выбранные сегменты поколения generation и заменяет их результатом в текущем поколении.
+    // Вызывается под merge_mutex_, но без write_mutex_
+    void MergeSegments(const Generation& generation, const std::vector<size_t>& segment_indexes);
+
+    void RunBackgroundMerges();
+};
+
+template <typename DocumentPredicate>
+std::vector<Document> ConcurrentSearchServer::Generation::FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+                                                                           size_t max_count) const {
+    // IDF считается по всем сегментам сразу, поэтому релевантность та же, что у единого индекса
+    CollectionStatistics collection;
+    for (const Segment& segment : segments) {
+        segment.index->AddCollectionStatistics(raw_query, collection, *segment.removed);
+    }
+    buffer->AddCollectionStatistics(raw_query, collection);
+
+    TopDocuments top_documents(max_count);
+    for (const Segment& segment : segments) {
+        const std::set<int>& removed_ids = *segment.removed;
+        const auto segment_predicate = [&removed_ids, &document_predicate](int document_id, DocumentStatus status, int rating) {
+            return removed_ids.count(document_id) == 0 && document_predicate(document_id, status, rating);
+        };
+        for (const Document& document : segment.index->FindTopDocuments(raw_query, segment_predicate, max_count, collection)) {
+            top_documents.Add(document);
+        }
+    }
+    for (const Document& document : buffer->FindTopDocuments(raw_query, document_predicate, max_count, collection)) {
+        top_documents.Add(document);
+    }
+    return top_documents.Extract();
+}
\ No newline at end of file
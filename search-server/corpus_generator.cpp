@@ -0,0 +1,141 @@
+#include "corpus_generator.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "string_processing.h"
+
+using namespace std::literals;
+
+CorpusGenerator::CorpusGenerator(const CorpusOptions& options)
+    : options_(options)
+    , generator_(options.seed) {
+    if (options_.vocabulary_size == 0 || options_.min_document_words == 0
+            || options_.min_document_words > options_.max_document_words) {
+        throw std::invalid_argument("Некорректные параметры корпуса"s);
+    }
+    std::uniform_int_distribution<size_t> length_distribution(2, 10);
+    std::unordered_set<std::string> used_words;
+    while (vocabulary_.size() < options_.vocabulary_size) {
+        std::string word = GenerateWord(length_distribution);
+        if (used_words.insert(word).second) {
+            vocabulary_.push_back(std::move(word));
+        }
+    }
+    while (stop_words_.size() < options_.stop_word_count) {
+        std::string word = GenerateWord(length_distribution);
+        if (used_words.insert(word).second) {
+            stop_words_.push_back(std::move(word));
+        }
+    }
+
+    cumulative_weights_.reserve(vocabulary_.size());
+    double total_weight = 0.0;
+    for (size_t rank = 1; rank <= vocabulary_.size(); ++rank) {
+        total_weight += 1.0 / std::pow(static_cast<double>(rank), options_.zipf_exponent);
+        cumulative_weights_.push_back(total_weight);
+    }
+}
+
+const CorpusOptions& CorpusGenerator::GetOptions() const {
+    return options_;
+}
+
+const std::vector<std::string>& CorpusGenerator::GetVocabulary() const {
+    return vocabulary_;
+}
+
+std::string CorpusGenerator::GetStopWords() const {
+    std::string result;
+    for (const std::string& word : stop_words_) {
+        if (!result.empty()) {
+            result += ' ';
+        }
+        result += word;
+    }
+    return result;
+}
+
+std::string CorpusGenerator::GenerateDocument() {
+    std::uniform_real_distribution<double> probability(0.0, 1.0);
+    if (!generated_documents_.empty() && probability(generator_) < options_.duplicate_ratio) {
+        const size_t source = std::uniform_int_distribution<size_t>(0, generated_documents_.size() - 1)(generator_);
+        std::vector<std::string_view> words = SplitIntoWords(generated_documents_[source]);
+        std::shuffle(words.begin(), words.end(), generator_);
+        std::string document;
+        for (std::string_view word : words) {
+            if (!document.empty()) {
+                document += ' ';
+            }
+            document += word;
+        }
+        generated_documents_.push_back(document);
+        return document;
+    }
+
+    const size_t word_count = std::uniform_int_distribution<size_t>(options_.min_document_words, options_.max_document_words)(generator_);
+    std::string document;
+    for (size_t i = 0; i < word_count; ++i) {
+        if (!document.empty()) {
+            document += ' ';
+        }
+        if (!stop_words_.empty() && probability(generator_) < options_.stop_word_ratio) {
+            document += stop_words_[std::uniform_int_distribution<size_t>(0, stop_words_.size() - 1)(generator_)];
+        } else {
+            document += SampleWord();
+        }
+    }
+    generated_documents_.push_back(document);
+    return document;
+}
+
+std::vector<std::string> CorpusGenerator::GenerateDocuments() {
+    std::vector<std::string> documents;
+    documents.reserve(options_.document_count);
+    for (size_t i = 0; i < options_.document_count; ++i) {
+        documents.push_back(GenerateDocument());
+    }
+    return documents;
+}
+
+std::string CorpusGenerator::GenerateQuery(size_t word_count, double minus_ratio) {
+    std::uniform_real_distribution<double> probability(0.0, 1.0);
+    std::string query;
+    for (size_t i = 0; i < word_count; ++i) {
+        if (!query.empty()) {
+            query += ' ';
+        }
+        if (probability(generator_) < minus_ratio) {
+            query += '-';
+        }
+        query += SampleWord();
+    }
+    return query;
+}
+
+std::vector<int> CorpusGenerator::GenerateRatings() {
+    const size_t rating_count = std::uniform_int_distribution<size_t>(1, 5)(generator_);
+    std::uniform_int_distribution<int> rating_distribution(-10, 10);
+    std::vector<int> ratings(rating_count);
+    for (int& rating : ratings) {
+        rating = rating_distribution(generator_);
+    }
+    return ratings;
+}
+
+std::string CorpusGenerator::GenerateWord(std::uniform_int_distribution<size_t>& length_distribution) {
+    std::uniform_int_distribution<int> letter_distribution('a', 'z');
+    std::string word(length_distribution(generator_), ' ');
+    for (char& letter : word) {
+        letter = static_cast<char>(letter_distribution(generator_));
+    }
+    return word;
+}
+
+const std::string& CorpusGenerator::SampleWord() {
+    const double point = std::uniform_real_distribution<double>(0.0, cumulative_weights_.back())(generator_);
+    const size_t rank = std::upper_bound(cumulative_weights_.begin(), cumulative_weights_.end(), point) - cumulative_weights_.begin();
+    return vocabulary_[std::min(rank, vocabulary_.size() - 1)];
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Параметры синтетического корпуса. При одинаковых параметрах генератор выдаёт один и тот же корпус
+struct CorpusOptions {
+    uint32_t seed = 42;
+    size_t document_count = 100'000;
+    size_t min_document_words = 10;
+    size_t max_document_words = 100;
+    size_t vocabulary_size = 50'000;
+    // Частота слова с рангом r пропорциональна 1 / r^zipf_exponent
+    double zipf_exponent = 1.0;
+    size_t stop_word_count = 50;
+    // Доля стоп-слов среди слов документа
+    double stop_word_ratio = 0.1;
+    // Доля документов, повторяющих набор слов одного из предыдущих документов в другом порядке
+    double duplicate_ratio = 0.01;
+};
+
+// Корпус со словарём, распределённым по закону Ципфа: слова, запросы, рейтинги
+class CorpusGenerator {
+public:
+    explicit CorpusGenerator(const CorpusOptions& options);
+
+    const CorpusOptions& GetOptions() const;
+
+    const std::vector<std::string>& GetVocabulary() const;
+
+    // Стоп-слова через пробел, в виде для конструктора SearchServer
+    std::string GetStopWords() const;
+
+    std::string GenerateDocument();
+
+    std::vector<std::string> GenerateDocuments();
+
+    // Доля minus_ratio слов запроса — минус-слова
+    std::string GenerateQuery(size_t word_count, double minus_ratio);
+
+    std::vector<int> GenerateRatings();
+
+private:
+    CorpusOptions options_;
+    std::mt19937 generator_;
+    std::vector<std::string> vocabulary_;
+    std::vector<std::string> stop_words_;
+    // Накопленные вероятности слов по рангу
+    std::vector<double> cumulative_weights_;
+    std::vector<std::string> generated_documents_;
+
+    std::string GenerateWord(std::uniform_int_distribution<size_t>& length_distribution);
+
+    const std::string& SampleWord();
+};
\ No newline at end of file
@@ -24,6 +24,8 @@ enum class DocumentStatus {
     REMOVED,
 };
 
+const size_t DOCUMENT_STATUS_COUNT = 4;
+
 void PrintDocument(const Document& document);
 
 std::ostream& operator<<(std::ostream& os, const Document& document);
\ No newline at end of file
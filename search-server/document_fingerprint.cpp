@@ -0,0 +1,40 @@
+#include "document_fingerprint.h"
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+
+namespace {
+
+// FNV-1a с разными начальными значениями даёт две независимые половины отпечатка
+uint64_t HashTerm(std::string_view term, uint64_t seed) {
+    uint64_t hash = seed;
+    for (const char c : term) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return MixHash(hash);
+}
+
+}  // namespace
+
+void DocumentFingerprint::AddTerm(std::string_view term) {
+    low += HashTerm(term, 14695981039346656037ull);
+    high += HashTerm(term, 0x9e3779b97f4a7c15ull);
+}
+
+bool operator==(const DocumentFingerprint& lhs, const DocumentFingerprint& rhs) {
+    return lhs.low == rhs.low && lhs.high == rhs.high;
+}
+
+bool operator!=(const DocumentFingerprint& lhs, const DocumentFingerprint& rhs) {
+    return !(lhs == rhs);
+}
+
+bool operator<(const DocumentFingerprint& lhs, const DocumentFingerprint& rhs) {
+    return std::tie(lhs.low, lhs.high) < std::tie(rhs.low, rhs.high);
+}
+
+uint64_t MixHash(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
\ No newline at end of file
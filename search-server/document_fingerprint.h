@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// 128-битный отпечаток множества слов документа: сумма хешей слов по модулю 2^64 в каждой половине.
+// Не зависит от порядка слов и от нумерации терминов, поэтому пересчитывается по одному слову
+// и совпадает у документов с одинаковым набором слов в разных индексах
+struct DocumentFingerprint {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    void AddTerm(std::string_view term);
+};
+
+bool operator==(const DocumentFingerprint& lhs, const DocumentFingerprint& rhs);
+
+bool operator!=(const DocumentFingerprint& lhs, const DocumentFingerprint& rhs);
+
+bool operator<(const DocumentFingerprint& lhs, const DocumentFingerprint& rhs);
+
+// Перемешивает биты 64-битного значения (финализатор SplitMix64)
+uint64_t MixHash(uint64_t value);
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "index_allocation.h"
+#include <memory>
+#include <memory_resource>
+
+namespace {
+
+// Первый блок монотонного ресурса; следующие растут в геометрической прогрессии
+const size_t MONOTONIC_INITIAL_BLOCK_SIZE = 64 * 1024;
+
+std::shared_ptr<std::pmr::memory_resource> MakeIndexResource(IndexAllocation allocation) {
+    switch (allocation) {
+        case IndexAllocation::POOLED:
+            // Индекс меняется из одного потока, поэтому пулам не нужна блокировка
+            return std::make_shared<std::pmr::unsynchronized_pool_resource>();
+        case IndexAllocation::MONOTONIC:
+            return std::make_shared<std::pmr::monotonic_buffer_resource>(MONOTONIC_INITIAL_BLOCK_SIZE);
+        default:
+            return nullptr;
+    }
+}
+
+}  // namespace
+
+IndexMemoryResource::IndexMemoryResource(IndexAllocation allocation)
+    : allocation_(allocation)
+    , resource_(MakeIndexResource(allocation)) {
+}
+
+IndexMemoryResource::IndexMemoryResource([[maybe_unused]] const IndexMemoryResource& other)
+    : allocation_(IndexAllocation::HEAP) {
+}
+
+IndexMemoryResource::IndexMemoryResource(IndexMemoryResource&& other) noexcept
+    : allocation_(other.allocation_)
+    , resource_(other.resource_) {
+}
+
+std::pmr::memory_resource* IndexMemoryResource::Get() const {
+    return resource_ != nullptr ? resource_.get() : std::pmr::get_default_resource();
+}
+
+IndexAllocation IndexMemoryResource::GetAllocation() const {
+    return allocation_;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+
+// Откуда берут память узлы словарей документов SearchServer: данные документов и множество id.
+// Списки документов терминов и прямой индекс — плоские векторы, их это не касается
+enum class IndexAllocation {
+    // Каждый узел — отдельное обращение к куче
+    HEAP,
+    // Пулы блоков одного размера: узлы удалённых документов достаются новым того же размера
+    POOLED,
+    // Узлы подряд в больших блоках без освобождения по одному: память удалённых документов
+    // возвращается только вместе с индексом. Только для индекса, который загружается целиком и не меняется
+    MONOTONIC,
+};
+
+// Ресурс памяти индекса. Копия индекса строит свои словари в обычной куче (так копируются pmr-контейнеры),
+// поэтому копия ресурса пуста. Перемещённый индекс продолжает пользоваться ресурсом исходного и делит его с ним
+class IndexMemoryResource {
+public:
+    explicit IndexMemoryResource(IndexAllocation allocation = IndexAllocation::HEAP);
+
+    IndexMemoryResource(const IndexMemoryResource& other);
+
+    IndexMemoryResource(IndexMemoryResource&& other) noexcept;
+
+    IndexMemoryResource& operator=(const IndexMemoryResource&) = delete;
+    IndexMemoryResource& operator=(IndexMemoryResource&&) = delete;
+
+    std::pmr::memory_resource* Get() const;
+
+    IndexAllocation GetAllocation() const;
+
+private:
+    IndexAllocation allocation_;
+    std::shared_ptr<std::pmr::memory_resource> resource_;
+};
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "instrumentation.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+struct StageRegistry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadStageBuffer>> buffers;
+    // Счётчики завершившихся потоков
+    ThreadStageBuffer retired;
+};
+
+StageRegistry& GetStageRegistry() {
+    // Реестр не разрушается, чтобы потоки, завершающиеся после выхода из main, могли в него писать
+    static StageRegistry* registry = new StageRegistry;
+    return *registry;
+}
+
+class ThreadStageBufferHolder {
+public:
+    ThreadStageBufferHolder()
+        : buffer_(std::make_shared<ThreadStageBuffer>()) {
+        StageRegistry& registry = GetStageRegistry();
+        std::lock_guard guard(registry.mutex);
+        registry.buffers.push_back(buffer_);
+    }
+
+    ~ThreadStageBufferHolder() {
+        StageRegistry& registry = GetStageRegistry();
+        std::lock_guard guard(registry.mutex);
+        registry.retired.MergeFrom(*buffer_);
+        registry.buffers.erase(std::find(registry.buffers.begin(), registry.buffers.end(), buffer_));
+    }
+
+    ThreadStageBuffer& Get() {
+        return *buffer_;
+    }
+
+private:
+    std::shared_ptr<ThreadStageBuffer> buffer_;
+};
+
+double ToSeconds(uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) / 1e9;
+}
+
+}  // namespace
+
+std::string_view GetStageName(InstrumentationStage stage) {
+    switch (stage) {
+        case InstrumentationStage::PARSE:
+            return "parse"sv;
+        case InstrumentationStage::POSTING_SCAN:
+            return "posting_scan"sv;
+        case InstrumentationStage::MINUS_FILTER:
+            return "minus_filter"sv;
+        case InstrumentationStage::ACCUMULATE:
+            return "accumulate"sv;
+        case InstrumentationStage::SORT:
+            return "sort"sv;
+        case InstrumentationStage::PAGINATE:
+            return "paginate"sv;
+    }
+    return "unknown"sv;
+}
+
+void ThreadStageBuffer::AddTo(std::array<StageTimings, INSTRUMENTATION_STAGE_COUNT>& timings) const {
+    for (size_t i = 0; i < INSTRUMENTATION_STAGE_COUNT; ++i) {
+        timings[i].count += counters_[i].count.load(std::memory_order_relaxed);
+        timings[i].total_ns += counters_[i].total_ns.load(std::memory_order_relaxed);
+        timings[i].max_ns = std::max(timings[i].max_ns, counters_[i].max_ns.load(std::memory_order_relaxed));
+    }
+}
+
+void ThreadStageBuffer::MergeFrom(const ThreadStageBuffer& other) {
+    for (size_t i = 0; i < INSTRUMENTATION_STAGE_COUNT; ++i) {
+        const Counters& source = other.counters_[i];
+        Counters& target = counters_[i];
+        target.count.fetch_add(source.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        target.total_ns.fetch_add(source.total_ns.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        target.max_ns.store(std::max(target.max_ns.load(std::memory_order_relaxed), source.max_ns.load(std::memory_order_relaxed)),
+                            std::memory_order_relaxed);
+    }
+}
+
+void ThreadStageBuffer::Reset() {
+    for (Counters& counters : counters_) {
+        counters.count.store(0, std::memory_order_relaxed);
+        counters.total_ns.store(0, std::memory_order_relaxed);
+        counters.max_ns.store(0, std::memory_order_relaxed);
+    }
+}
+
+ThreadStageBuffer& GetThreadStageBuffer() {
+    thread_local ThreadStageBufferHolder holder;
+    return holder.Get();
+}
+
+std::vector<StageTimings> GetStageTimings() {
+    std::array<StageTimings, INSTRUMENTATION_STAGE_COUNT> timings{};
+    {
+        StageRegistry& registry = GetStageRegistry();
+        std::lock_guard guard(registry.mutex);
+        registry.retired.AddTo(timings);
+        for (const auto& buffer : registry.buffers) {
+            buffer->AddTo(timings);
+        }
+    }
+    for (size_t i = 0; i < INSTRUMENTATION_STAGE_COUNT; ++i) {
+        timings[i].name = GetStageName(static_cast<InstrumentationStage>(i));
+    }
+    return {timings.begin(), timings.end()};
+}
+
+void ResetStageTimings() {
+    // Замер, который поток записывает прямо во время сброса, может частично пережить сброс
+    StageRegistry& registry = GetStageRegistry();
+    std::lock_guard guard(registry.mutex);
+    registry.retired.Reset();
+    for (const auto& buffer : registry.buffers) {
+        buffer->Reset();
+    }
+}
+
+std::string DumpStageTimingsJson() {
+    std::ostringstream out;
+    out << "{\"enabled\": "s << (IsInstrumentationEnabled() ? "true"s : "false"s) << ", \"stages\": ["s;
+    bool is_first = true;
+    for (const StageTimings& timings : GetStageTimings()) {
+        out << (is_first ? ""s : ", "s) << "{\"stage\": \""s << timings.name << "\", \"count\": "s << timings.count
+            << ", \"total_ns\": "s << timings.total_ns << ", \"max_ns\": "s << timings.max_ns << "}"s;
+        is_first = false;
+    }
+    out << "]}"s;
+    return out.str();
+}
+
+std::string DumpStageTimingsPrometheus() {
+    const std::vector<StageTimings> all_timings = GetStageTimings();
+    std::ostringstream out;
+    out << "# HELP search_server_stage_seconds Time spent in search pipeline stages.\n"s
+        << "# TYPE search_server_stage_seconds summary\n"s;
+    for (const StageTimings& timings : all_timings) {
+        out << "search_server_stage_seconds_sum{stage=\""s << timings.name << "\"} "s << ToSeconds(timings.total_ns) << '\n';
+        out << "search_server_stage_seconds_count{stage=\""s << timings.name << "\"} "s << timings.count << '\n';
+    }
+    out << "# HELP search_server_stage_max_seconds Longest single execution of a search pipeline stage.\n"s
+        << "# TYPE search_server_stage_max_seconds gauge\n"s;
+    for (const StageTimings& timings : all_timings) {
+        out << "search_server_stage_max_seconds{stage=\""s << timings.name << "\"} "s << ToSeconds(timings.max_ns) << '\n';
+    }
+    return out.str();
+}
+
+bool IsInstrumentationEnabled() {
+#ifdef SEARCH_SERVER_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Замеры этапов поиска включаются флагом компиляции -DSEARCH_SERVER_INSTRUMENTATION.
+// Без него INSTRUMENT_STAGE не разворачивается ни во что и в горячих циклах нет даже чтения часов
+
+enum class InstrumentationStage {
+    // Разбор запроса
+    PARSE,
+    // Обход списков плюс-слов вместе с добавлением вкладов в аккумулятор; для MAX_SCORE — весь цикл по кандидатам
+    POSTING_SCAN,
+    // Исключение документов с минус-словами
+    MINUS_FILTER,
+    // Перенос набранной релевантности в TopDocuments
+    ACCUMULATE,
+    // Сортировка отобранных документов
+    SORT,
+    // Разбиение результатов на страницы
+    PAGINATE,
+};
+
+const size_t INSTRUMENTATION_STAGE_COUNT = 6;
+
+std::string_view GetStageName(InstrumentationStage stage);
+
+struct StageTimings {
+    std::string_view name;
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+// Счётчики одного потока. Пишет в них только поток-владелец, поэтому атомарные операции
+// не соперничают за кеш-линию; атомарность нужна лишь для чтения при сборе и для сброса
+class ThreadStageBuffer {
+public:
+    void Record(InstrumentationStage stage, uint64_t nanoseconds) {
+        Counters& counters = counters_[static_cast<size_t>(stage)];
+        counters.count.fetch_add(1, std::memory_order_relaxed);
+        counters.total_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+        if (counters.max_ns.load(std::memory_order_relaxed) < nanoseconds) {
+            counters.max_ns.store(nanoseconds, std::memory_order_relaxed);
+        }
+    }
+
+    void AddTo(std::array<StageTimings, INSTRUMENTATION_STAGE_COUNT>& timings) const;
+
+    // Вызывается под блокировкой реестра, когда other уже никто не пишет
+    void MergeFrom(const ThreadStageBuffer& other);
+
+    void Reset();
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+    };
+    std::array<Counters, INSTRUMENTATION_STAGE_COUNT> counters_;
+};
+
+// Буфер текущего потока; при первом обращении регистрируется, а при завершении потока его счётчики
+// переносятся в общий буфер завершившихся потоков
+ThreadStageBuffer& GetThreadStageBuffer();
+
+// Сумма по всем потокам на момент вызова
+std::vector<StageTimings> GetStageTimings();
+
+void ResetStageTimings();
+
+std::string DumpStageTimingsJson();
+
+// Текстовый формат Prometheus: сводка search_server_stage_seconds и максимум search_server_stage_max_seconds
+std::string DumpStageTimingsPrometheus();
+
+bool IsInstrumentationEnabled();
+
+class ScopedStageTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ScopedStageTimer(InstrumentationStage stage)
+        : stage_(stage) {
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+    ~ScopedStageTimer() {
+        const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time_);
+        GetThreadStageBuffer().Record(stage_, static_cast<uint64_t>(duration.count()));
+    }
+
+private:
+    const InstrumentationStage stage_;
+    const Clock::time_point start_time_ = Clock::now();
+};
+
+#ifdef SEARCH_SERVER_INSTRUMENTATION
+#define INSTRUMENT_CONCAT_INTERNAL(X, Y) X##Y
+#define INSTRUMENT_CONCAT(X, Y) INSTRUMENT_CONCAT_INTERNAL(X, Y)
+#define INSTRUMENT_STAGE(stage) ScopedStageTimer INSTRUMENT_CONCAT(stageTimer, __LINE__)(stage)
+#else
+#define INSTRUMENT_STAGE(stage) static_cast<void>(0)
+#endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <vector>
+#include "benchmark.h"
 #include "document.h"
 #include "paginator.h"
 #include "read_input_functions.h"
@@ -12,7 +14,7 @@
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
     SearchServer search_server("and with"s);
 
     AddDocument(search_server, 1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {7, 2, 7});
@@ -42,4 +44,32 @@ int main() {
     cout << "Before duplicates removed: "s << search_server.GetDocumentCount() << endl;
     RemoveDuplicates(search_server);
     cout << "After duplicates removed: "s << search_server.GetDocumentCount() << endl;
+
+    // Сравнительные замеры идут несколько минут, поэтому запускаются только по флагу
+    if (argc < 2 || argv[1] != "--benchmarks"sv) {
+        return 0;
+    }
+
+    BenchmarkExecutionPolicies();
+    BenchmarkProcessQueries();
+    BenchmarkQueryAllocations();
+    BenchmarkIndexMemory();
+    BenchmarkPostingScan();
+    BenchmarkTopDocuments();
+    BenchmarkMaxScore();
+    BenchmarkSnapshot();
+    BenchmarkBulkLoad();
+    BenchmarkConcurrentUpdates();
+    BenchmarkRemoveDocuments();
+    BenchmarkDuplicates();
+    BenchmarkQueryCache();
+    BenchmarkQueryProfile();
+    BenchmarkStatusFilters();
+    BenchmarkRequestQueue();
+    BenchmarkInstrumentation();
+    BenchmarkShardedSearch();
+    BenchmarkDeepPagination();
+    BenchmarkIndexAllocation();
+    BenchmarkPostingCompression();
+    BenchmarkMatchDocuments();
 } 
\ No newline at end of file
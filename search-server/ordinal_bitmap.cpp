@@ -0,0 +1,41 @@
+#include "ordinal_bitmap.h"
+#include <cstdint>
+#include <vector>
+
+void OrdinalBitmap::Set(int ordinal) {
+    const size_t word_index = static_cast<size_t>(ordinal) / 64;
+    if (word_index >= words_.size()) {
+        words_.resize(word_index + 1);
+    }
+    const uint64_t bit = uint64_t{1} << (ordinal % 64);
+    if ((words_[word_index] & bit) == 0) {
+        words_[word_index] |= bit;
+        ++count_;
+    }
+}
+
+void OrdinalBitmap::Reset(int ordinal) {
+    if (!Test(ordinal)) {
+        return;
+    }
+    words_[ordinal / 64] &= ~(uint64_t{1} << (ordinal % 64));
+    --count_;
+}
+
+bool OrdinalBitmap::Test(int ordinal) const {
+    const size_t word_index = static_cast<size_t>(ordinal) / 64;
+    return word_index < words_.size() && (words_[word_index] >> (ordinal % 64) & 1) != 0;
+}
+
+size_t OrdinalBitmap::Count() const {
+    return count_;
+}
+
+void OrdinalBitmap::Clear() {
+    words_.clear();
+    count_ = 0;
+}
+
+size_t OrdinalBitmap::GetMemoryUsage() const {
+    return words_.capacity() * sizeof(uint64_t);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Множество порядковых номеров документов в виде битовой карты и число номеров в нём.
+// Проверка номера — одно чтение слова, а обход номеров по возрастанию пропускает пустые слова целиком
+class OrdinalBitmap {
+public:
+    // Номер может быть больше всех добавленных ранее: карта растёт сама
+    void Set(int ordinal);
+
+    void Reset(int ordinal);
+
+    bool Test(int ordinal) const;
+
+    size_t Count() const;
+
+    void Clear();
+
+    size_t GetMemoryUsage() const;
+
+    // Вызывает callback(ordinal) для каждого номера множества по возрастанию.
+    // Если callback возвращает false, обход прекращается
+    template <typename Callback>
+    void ForEach(Callback callback) const;
+
+private:
+    std::vector<uint64_t> words_;
+    size_t count_ = 0;
+};
+
+template <typename Callback>
+void OrdinalBitmap::ForEach(Callback callback) const {
+    for (size_t word_index = 0; word_index < words_.size(); ++word_index) {
+        for (uint64_t word = words_[word_index]; word != 0; word &= word - 1) {
+            if (!callback(static_cast<int>(word_index * 64 + __builtin_ctzll(word)))) {
+                return;
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -1,62 +1,141 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
-#include <vector>
+#include <iterator>
+#include <type_traits>
+#include "instrumentation.h"
 
 template <typename Iter>
 class IteratorRange {
     public:
-    
-    IteratorRange(Iter begin, size_t size) : range_begin(begin), range_end(begin + size)
+
+    IteratorRange(Iter begin, Iter end) : range_begin(begin), range_end(end)
+    {}
+
+    IteratorRange(Iter begin, size_t size) : range_begin(begin), range_end(std::next(begin, size))
     {}
-     
+
     auto begin() const {
     return range_begin;
     }
-    
+
     auto end() const {
     return range_end;
     }
-    
+
     size_t size() const {
-    return distance(range_begin, range_end);
+    return std::distance(range_begin, range_end);
     }
-     
+
     private:
-    
+
     Iter range_begin;
     Iter range_end;
 };
 
+// Сдвигает it на count позиций, но не дальше end
+template <typename Iter>
+Iter AdvanceWithin(Iter it, Iter end, size_t count) {
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>) {
+        return it + std::min<typename std::iterator_traits<Iter>::difference_type>(count, end - it);
+    } else {
+        for (; count > 0 && it != end; --count) {
+            ++it;
+        }
+        return it;
+    }
+}
 
+// Страницы строятся по мере обхода: Paginator хранит только границы диапазона и размер страницы.
+// Подходят любые прямые итераторы; для итераторов произвольного доступа GetPage и size работают за O(1)
 template <typename Iter>
 class Paginator {
 public:
-    
-    Paginator(Iter begin, Iter end, size_t size) {
-        for (auto i = begin; i != end; advance(i, size)) {
-            if (end - i < size) {
-                size -= (end - i);
-            }
-            pages.push_back(IteratorRange<Iter>(i, size));
+    class PageIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = IteratorRange<Iter>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = value_type;
+
+        PageIterator(Iter page_begin, Iter end, size_t page_size)
+            : page_begin_(page_begin)
+            , page_end_(AdvanceWithin(page_begin, end, page_size))
+            , end_(end)
+            , page_size_(page_size) {
+        }
+
+        value_type operator*() const {
+            return IteratorRange<Iter>(page_begin_, page_end_);
+        }
+
+        // Граница следующей страницы ищется только при переходе к ней
+        PageIterator& operator++() {
+            INSTRUMENT_STAGE(InstrumentationStage::PAGINATE);
+            page_begin_ = page_end_;
+            page_end_ = AdvanceWithin(page_begin_, end_, page_size_);
+            return *this;
         }
+
+        PageIterator operator++(int) {
+            PageIterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const PageIterator& other) const {
+            return page_begin_ == other.page_begin_;
+        }
+
+        bool operator!=(const PageIterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        Iter page_begin_;
+        Iter page_end_;
+        Iter end_;
+        size_t page_size_;
+    };
+
+    // При page_size == 0 страниц нет
+    Paginator(Iter begin, Iter end, size_t page_size)
+        : begin_(begin)
+        , end_(page_size == 0 ? begin : end)
+        , page_size_(page_size) {
     }
-    
-    auto begin() const {
-    return pages.begin();
+
+    PageIterator begin() const {
+        return PageIterator(begin_, end_, page_size_);
     }
-    
-    auto end() const {
-    return pages.end();
+
+    PageIterator end() const {
+        return PageIterator(end_, end_, page_size_);
     }
-    
+
     size_t size() const {
-    return pages.size();
+        const size_t item_count = std::distance(begin_, end_);
+        return page_size_ == 0 ? 0 : (item_count + page_size_ - 1) / page_size_;
     }
-    
+
+    // Страница page_index (с нуля); за последней страницей — пустой диапазон
+    IteratorRange<Iter> GetPage(size_t page_index) const {
+        INSTRUMENT_STAGE(InstrumentationStage::PAGINATE);
+        Iter page_begin = begin_;
+        if (page_size_ != 0 && page_index > 0) {
+            const size_t item_count = std::distance(begin_, end_);
+            page_begin = AdvanceWithin(begin_, end_, std::min(page_index, item_count / page_size_ + 1) * page_size_);
+        }
+        return IteratorRange<Iter>(page_begin, AdvanceWithin(page_begin, end_, page_size_));
+    }
+
 private:
-    
-    std::vector<IteratorRange<Iter>> pages;
+    Iter begin_;
+    Iter end_;
+    size_t page_size_;
 };
 
 template <typename Container>
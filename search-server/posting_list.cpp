@@ -0,0 +1,560 @@
+#include "posting_list.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+namespace {
+
+// Нули после последнего блока: распаковка читает по 8 байт и может выйти за конец упакованных данных
+const size_t BLOCK_DATA_PADDING = sizeof(uint64_t);
+
+uint8_t GetBitWidth(uint64_t value) {
+    uint8_t bits = 0;
+    while (value >> bits != 0) {
+        ++bits;
+    }
+    return bits;
+}
+
+size_t GetPackedSize(size_t count, uint8_t bits) {
+    return (count * bits + 7) / 8;
+}
+
+// Дописывает count значений по bits бит в out, младшими битами вперёд
+void PackBits(const uint32_t* values, size_t count, uint8_t bits, std::vector<uint8_t>& out) {
+    const size_t start = out.size();
+    out.resize(start + GetPackedSize(count, bits) + sizeof(uint64_t), 0);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t bit = i * bits;
+        uint64_t word;
+        std::memcpy(&word, out.data() + start + bit / 8, sizeof(word));
+        word |= static_cast<uint64_t>(values[i]) << (bit % 8);
+        std::memcpy(out.data() + start + bit / 8, &word, sizeof(word));
+    }
+    out.resize(start + GetPackedSize(count, bits));
+}
+
+// Ширина значений одинакова во всём блоке, поэтому в цикле нет ветвлений
+void UnpackBits(const uint8_t* data, size_t count, uint8_t bits, uint32_t* values) {
+    const uint64_t mask = (uint64_t{1} << bits) - 1;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t bit = i * bits;
+        uint64_t word;
+        std::memcpy(&word, data + bit / 8, sizeof(word));
+        values[i] = static_cast<uint32_t>((word >> (bit % 8)) & mask);
+    }
+}
+
+uint32_t UnpackBitsAt(const uint8_t* data, size_t index, uint8_t bits) {
+    const size_t bit = index * bits;
+    uint64_t word;
+    std::memcpy(&word, data + bit / 8, sizeof(word));
+    return static_cast<uint32_t>((word >> (bit % 8)) & ((uint64_t{1} << bits) - 1));
+}
+
+// Элементы до первого удаляемого id остаются на месте, остальные сдвигаются за один проход
+size_t RemoveSortedFrom(std::vector<int>& document_ids, std::vector<double>& term_freqs, const int* first, const int* last) {
+    size_t write_pos = std::lower_bound(document_ids.begin(), document_ids.end(), *first) - document_ids.begin();
+    const size_t old_size = document_ids.size();
+    for (size_t read_pos = write_pos; read_pos < old_size; ++read_pos) {
+        first = std::lower_bound(first, last, document_ids[read_pos]);
+        if (first != last && *first == document_ids[read_pos]) {
+            continue;
+        }
+        document_ids[write_pos] = document_ids[read_pos];
+        term_freqs[write_pos] = term_freqs[read_pos];
+        ++write_pos;
+    }
+    document_ids.resize(write_pos);
+    term_freqs.resize(write_pos);
+    return old_size - write_pos;
+}
+
+}  // namespace
+
+PostingList::PostingList(PostingFormat format)
+    : format_(format) {
+}
+
+PostingList::PostingList(const PostingList& other)
+    : document_ids_(other.document_ids_)
+    , term_freqs_(other.term_freqs_)
+    , tail_document_ids_(other.tail_document_ids_)
+    , tail_term_freqs_(other.tail_term_freqs_)
+    , max_term_freq_(other.max_term_freq_)
+    , format_(other.format_)
+    , blocks_(other.blocks_)
+    , block_storage_(other.block_storage_ != nullptr ? std::make_unique<BlockStorage>(*other.block_storage_) : nullptr)
+    , external_document_ids_(other.external_document_ids_)
+    , external_term_freqs_(other.external_term_freqs_)
+    , external_size_(other.external_size_) {
+}
+
+PostingList& PostingList::operator=(const PostingList& other) {
+    if (this != &other) {
+        *this = PostingList(other);
+    }
+    return *this;
+}
+
+PostingList PostingList::FromExternal(const int* document_ids, const double* term_freqs, size_t size, double max_term_freq) {
+    PostingList postings;
+    postings.external_document_ids_ = document_ids;
+    postings.external_term_freqs_ = term_freqs;
+    postings.external_size_ = size;
+    postings.max_term_freq_ = max_term_freq;
+    return postings;
+}
+
+void PostingList::Add(int document_id, double term_freq) {
+    DetachExternal();
+
+    const bool is_after_main = document_ids_.empty()
+        ? blocks_.empty() || blocks_.back().last_document_id < document_id
+        : document_ids_.back() < document_id;
+    if (tail_document_ids_.empty() && is_after_main) {
+        document_ids_.push_back(document_id);
+        term_freqs_.push_back(term_freq);
+        max_term_freq_ = std::max(max_term_freq_, term_freq);
+        if (document_ids_.size() == BLOCK_SIZE) {
+            Pack();
+        }
+        return;
+    }
+
+    // Частоту документа из сжатого блока можно изменить только в распакованном списке
+    const size_t block_index = FindBlock(document_id, 0);
+    if (block_index < blocks_.size() && blocks_[block_index].first_document_id <= document_id) {
+        int block_ids[BLOCK_SIZE];
+        DecodeBlockIds(block_index, block_ids);
+        if (std::binary_search(block_ids, block_ids + BLOCK_SIZE, document_id)) {
+            Unpack();
+        }
+    }
+
+    const auto main_it = std::lower_bound(document_ids_.begin(), document_ids_.end(), document_id);
+    if (main_it != document_ids_.end() && *main_it == document_id) {
+        double& stored_freq = term_freqs_[main_it - document_ids_.begin()];
+        stored_freq += term_freq;
+        max_term_freq_ = std::max(max_term_freq_, stored_freq);
+        Pack();
+        return;
+    }
+
+    const auto tail_it = std::lower_bound(tail_document_ids_.begin(), tail_document_ids_.end(), document_id);
+    const size_t tail_pos = tail_it - tail_document_ids_.begin();
+    if (tail_it != tail_document_ids_.end() && *tail_it == document_id) {
+        tail_term_freqs_[tail_pos] += term_freq;
+        max_term_freq_ = std::max(max_term_freq_, tail_term_freqs_[tail_pos]);
+        return;
+    }
+    tail_document_ids_.insert(tail_it, document_id);
+    tail_term_freqs_.insert(tail_term_freqs_.begin() + tail_pos, term_freq);
+    max_term_freq_ = std::max(max_term_freq_, term_freq);
+
+    if (tail_document_ids_.size() > MAX_TAIL_SIZE) {
+        MergeTail();
+    }
+}
+
+bool PostingList::Remove(int document_id) {
+    return RemoveSorted(&document_id, &document_id + 1) > 0;
+}
+
+size_t PostingList::RemoveSorted(const int* first, const int* last) {
+    if (first == last || empty()) {
+        return 0;
+    }
+    DetachExternal();
+    if (!blocks_.empty() && *first <= blocks_.back().last_document_id) {
+        Unpack();
+    }
+    const size_t removed_count = RemoveSortedFrom(document_ids_, term_freqs_, first, last)
+        + RemoveSortedFrom(tail_document_ids_, tail_term_freqs_, first, last);
+    if (empty()) {
+        *this = PostingList(format_);
+    } else {
+        Pack();
+    }
+    return removed_count;
+}
+
+std::optional<double> PostingList::FindTermFreq(int document_id) const {
+    const size_t block_index = FindBlock(document_id, 0);
+    if (block_index < blocks_.size()) {
+        if (blocks_[block_index].first_document_id <= document_id) {
+            int block_ids[BLOCK_SIZE];
+            DecodeBlockIds(block_index, block_ids);
+            const int* block_it = std::lower_bound(block_ids, block_ids + BLOCK_SIZE, document_id);
+            if (*block_it == document_id) {
+                return DecodeBlockTermFreq(block_index, block_it - block_ids);
+            }
+        }
+    } else {
+        const int* main_ids = GetMainIds();
+        const int* main_it = std::lower_bound(main_ids, main_ids + GetMainSize(), document_id);
+        if (main_it != main_ids + GetMainSize() && *main_it == document_id) {
+            return GetMainFreqs()[main_it - main_ids];
+        }
+    }
+    const auto tail_it = std::lower_bound(tail_document_ids_.begin(), tail_document_ids_.end(), document_id);
+    if (tail_it != tail_document_ids_.end() && *tail_it == document_id) {
+        return tail_term_freqs_[tail_it - tail_document_ids_.begin()];
+    }
+    return std::nullopt;
+}
+
+bool PostingList::Contains(int document_id) const {
+    return FindTermFreq(document_id).has_value();
+}
+
+size_t PostingList::size() const {
+    return GetCompressedSize() + GetMainSize() + tail_document_ids_.size();
+}
+
+bool PostingList::empty() const {
+    return size() == 0;
+}
+
+double PostingList::GetMaxTermFreq() const {
+    return max_term_freq_;
+}
+
+PostingFormat PostingList::GetFormat() const {
+    return format_;
+}
+
+void PostingList::SetFormat(PostingFormat format) {
+    if (format == format_) {
+        return;
+    }
+    DetachExternal();
+    Unpack();
+    format_ = format;
+    Pack();
+    // Список перестраивается целиком, поэтому запас ёмкости больше не нужен
+    document_ids_.shrink_to_fit();
+    term_freqs_.shrink_to_fit();
+    blocks_.shrink_to_fit();
+    if (block_storage_ != nullptr) {
+        block_storage_->data.shrink_to_fit();
+        block_storage_->freq_values.shrink_to_fit();
+        block_storage_->freq_value_order.shrink_to_fit();
+    }
+}
+
+PostingList::MonotoneLookup::MonotoneLookup(const PostingList& postings)
+    : postings_(&postings) {
+}
+
+bool PostingList::MonotoneLookup::Contains(int document_id) {
+    block_pos_ = postings_->FindBlock(document_id, block_pos_);
+    if (block_pos_ < postings_->blocks_.size()) {
+        if (postings_->blocks_[block_pos_].first_document_id <= document_id) {
+            if (decoded_block_ != block_pos_) {
+                postings_->DecodeBlockIds(block_pos_, block_ids_);
+                decoded_block_ = block_pos_;
+                main_pos_ = 0;
+            }
+            // Последний id блока не меньше document_id, поэтому позиция не выходит за блок
+            main_pos_ = GallopLowerBound(block_ids_, BLOCK_SIZE, main_pos_, document_id);
+            if (block_ids_[main_pos_] == document_id) {
+                return true;
+            }
+        }
+    } else {
+        if (decoded_block_ != NO_BLOCK) {
+            decoded_block_ = NO_BLOCK;
+            main_pos_ = 0;
+        }
+        const int* main_ids = postings_->GetMainIds();
+        const size_t main_size = postings_->GetMainSize();
+        main_pos_ = GallopLowerBound(main_ids, main_size, main_pos_, document_id);
+        if (main_pos_ < main_size && main_ids[main_pos_] == document_id) {
+            return true;
+        }
+    }
+    const std::vector<int>& tail_ids = postings_->tail_document_ids_;
+    tail_pos_ = GallopLowerBound(tail_ids.data(), tail_ids.size(), tail_pos_, document_id);
+    return tail_pos_ < tail_ids.size() && tail_ids[tail_pos_] == document_id;
+}
+
+PostingList::Cursor::Cursor(const PostingList& postings)
+    : postings_(&postings) {
+    DecodeCurrentBlock();
+}
+
+bool PostingList::Cursor::AtEnd() const {
+    return main_pos_ == postings_->GetCompressedSize() + postings_->GetMainSize()
+        && tail_pos_ == postings_->tail_document_ids_.size();
+}
+
+int PostingList::Cursor::GetDocumentId() const {
+    return IsMainCurrent() ? GetMainDocumentId() : postings_->tail_document_ids_[tail_pos_];
+}
+
+double PostingList::Cursor::GetTermFreq() const {
+    if (!IsMainCurrent()) {
+        return postings_->tail_term_freqs_[tail_pos_];
+    }
+    const size_t compressed_size = postings_->GetCompressedSize();
+    return main_pos_ < compressed_size ? block_freqs_[main_pos_ % BLOCK_SIZE] : postings_->GetMainFreqs()[main_pos_ - compressed_size];
+}
+
+void PostingList::Cursor::Next() {
+    if (IsMainCurrent()) {
+        ++main_pos_;
+        DecodeCurrentBlock();
+    } else {
+        ++tail_pos_;
+    }
+}
+
+void PostingList::Cursor::SeekTo(int document_id) {
+    const size_t compressed_size = postings_->GetCompressedSize();
+    if (main_pos_ < compressed_size) {
+        // Блоки, которые целиком раньше document_id, пропускаются по таблице без распаковки
+        const size_t block_index = postings_->FindBlock(document_id, main_pos_ / BLOCK_SIZE);
+        if (block_index < postings_->blocks_.size()) {
+            main_pos_ = std::max(main_pos_, block_index * BLOCK_SIZE);
+            DecodeCurrentBlock();
+            main_pos_ = block_index * BLOCK_SIZE + GallopLowerBound(block_ids_, BLOCK_SIZE, main_pos_ % BLOCK_SIZE, document_id);
+        } else {
+            main_pos_ = compressed_size;
+        }
+    }
+    if (main_pos_ >= compressed_size) {
+        main_pos_ = compressed_size
+            + GallopLowerBound(postings_->GetMainIds(), postings_->GetMainSize(), main_pos_ - compressed_size, document_id);
+    }
+    const std::vector<int>& tail_ids = postings_->tail_document_ids_;
+    tail_pos_ = GallopLowerBound(tail_ids.data(), tail_ids.size(), tail_pos_, document_id);
+}
+
+double PostingList::Cursor::GetBlockMaxTermFreq(int document_id) const {
+    if (!postings_->tail_document_ids_.empty() || main_pos_ >= postings_->GetCompressedSize()) {
+        return postings_->max_term_freq_;
+    }
+    const size_t block_index = postings_->FindBlock(document_id, main_pos_ / BLOCK_SIZE);
+    if (block_index == postings_->blocks_.size()) {
+        return postings_->max_term_freq_;
+    }
+    const BlockInfo& block = postings_->blocks_[block_index];
+    return block.first_document_id <= document_id ? block.max_term_freq : 0.0;
+}
+
+bool PostingList::Cursor::IsMainCurrent() const {
+    const std::vector<int>& tail_ids = postings_->tail_document_ids_;
+    return tail_pos_ == tail_ids.size()
+        || (main_pos_ < postings_->GetCompressedSize() + postings_->GetMainSize() && GetMainDocumentId() < tail_ids[tail_pos_]);
+}
+
+int PostingList::Cursor::GetMainDocumentId() const {
+    const size_t compressed_size = postings_->GetCompressedSize();
+    return main_pos_ < compressed_size ? block_ids_[main_pos_ % BLOCK_SIZE] : postings_->GetMainIds()[main_pos_ - compressed_size];
+}
+
+void PostingList::Cursor::DecodeCurrentBlock() {
+    const size_t block_index = main_pos_ / BLOCK_SIZE;
+    if (main_pos_ < postings_->GetCompressedSize() && block_index != decoded_block_) {
+        postings_->DecodeBlock(block_index, block_ids_, block_freqs_);
+        decoded_block_ = block_index;
+    }
+}
+
+size_t PostingList::GetMemoryUsage() const {
+    return (document_ids_.capacity() + tail_document_ids_.capacity()) * sizeof(int)
+        + (term_freqs_.capacity() + tail_term_freqs_.capacity()) * sizeof(double)
+        + blocks_.capacity() * sizeof(BlockInfo)
+        + (block_storage_ == nullptr ? 0
+            : sizeof(BlockStorage) + block_storage_->data.capacity() + block_storage_->freq_values.capacity() * sizeof(double)
+                + block_storage_->freq_value_order.capacity() * sizeof(uint32_t));
+}
+
+const int* PostingList::GetMainIds() const {
+    return external_document_ids_ != nullptr ? external_document_ids_ : document_ids_.data();
+}
+
+const double* PostingList::GetMainFreqs() const {
+    return external_document_ids_ != nullptr ? external_term_freqs_ : term_freqs_.data();
+}
+
+size_t PostingList::GetMainSize() const {
+    return external_document_ids_ != nullptr ? external_size_ : document_ids_.size();
+}
+
+size_t PostingList::GetCompressedSize() const {
+    return blocks_.size() * BLOCK_SIZE;
+}
+
+size_t PostingList::FindBlock(int document_id, size_t from) const {
+    return std::partition_point(blocks_.begin() + from, blocks_.end(), [document_id](const BlockInfo& block) {
+        return block.last_document_id < document_id;
+    }) - blocks_.begin();
+}
+
+void PostingList::DecodeBlockIds(size_t block_index, int* document_ids) const {
+    const BlockInfo& block = blocks_[block_index];
+    uint32_t deltas[BLOCK_SIZE];
+    UnpackBits(block_storage_->data.data() + block.offset, BLOCK_SIZE, block.id_bits, deltas);
+    int document_id = block.first_document_id;
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        document_id += static_cast<int>(deltas[i]);
+        document_ids[i] = document_id;
+    }
+}
+
+void PostingList::DecodeBlock(size_t block_index, int* document_ids, double* term_freqs) const {
+    DecodeBlockIds(block_index, document_ids);
+    const BlockInfo& block = blocks_[block_index];
+    uint32_t freq_indices[BLOCK_SIZE];
+    UnpackBits(block_storage_->data.data() + block.offset + GetPackedSize(BLOCK_SIZE, block.id_bits), BLOCK_SIZE,
+               block.freq_index_bits, freq_indices);
+    const double* freq_values = block_storage_->freq_values.data();
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        term_freqs[i] = freq_values[freq_indices[i]];
+    }
+}
+
+double PostingList::DecodeBlockTermFreq(size_t block_index, size_t position) const {
+    const BlockInfo& block = blocks_[block_index];
+    return block_storage_->freq_values[UnpackBitsAt(block_storage_->data.data() + block.offset + GetPackedSize(BLOCK_SIZE, block.id_bits),
+                                                    position, block.freq_index_bits)];
+}
+
+uint32_t PostingList::GetFreqValueIndex(double term_freq) {
+    std::vector<double>& freq_values = block_storage_->freq_values;
+    std::vector<uint32_t>& freq_value_order = block_storage_->freq_value_order;
+    const auto it = std::lower_bound(freq_value_order.begin(), freq_value_order.end(), term_freq, [&freq_values](uint32_t index, double value) {
+        return freq_values[index] < value;
+    });
+    if (it != freq_value_order.end() && freq_values[*it] == term_freq) {
+        return *it;
+    }
+    const auto index = static_cast<uint32_t>(freq_values.size());
+    freq_values.push_back(term_freq);
+    freq_value_order.insert(it, index);
+    return index;
+}
+
+void PostingList::AppendBlock(const int* document_ids, const double* term_freqs) {
+    BlockInfo block;
+    block.first_document_id = document_ids[0];
+    block.last_document_id = document_ids[BLOCK_SIZE - 1];
+    block.max_term_freq = *std::max_element(term_freqs, term_freqs + BLOCK_SIZE);
+
+    // Первая разность нулевая: первый id хранится в таблице пропусков
+    uint32_t deltas[BLOCK_SIZE];
+    deltas[0] = 0;
+    for (size_t i = 1; i < BLOCK_SIZE; ++i) {
+        deltas[i] = static_cast<uint32_t>(document_ids[i] - document_ids[i - 1]);
+    }
+    block.id_bits = GetBitWidth(*std::max_element(deltas, deltas + BLOCK_SIZE));
+
+    if (block_storage_ == nullptr) {
+        block_storage_ = std::make_unique<BlockStorage>();
+    }
+    uint32_t freq_indices[BLOCK_SIZE];
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        freq_indices[i] = GetFreqValueIndex(term_freqs[i]);
+    }
+    block.freq_index_bits = GetBitWidth(*std::max_element(freq_indices, freq_indices + BLOCK_SIZE));
+
+    std::vector<uint8_t>& data = block_storage_->data;
+    if (!data.empty()) {
+        data.resize(data.size() - BLOCK_DATA_PADDING);
+    }
+    block.offset = static_cast<uint32_t>(data.size());
+    PackBits(deltas, BLOCK_SIZE, block.id_bits, data);
+    PackBits(freq_indices, BLOCK_SIZE, block.freq_index_bits, data);
+    data.resize(data.size() + BLOCK_DATA_PADDING, 0);
+    blocks_.push_back(block);
+}
+
+void PostingList::Unpack() {
+    if (blocks_.empty()) {
+        return;
+    }
+    std::vector<int> document_ids(GetCompressedSize() + document_ids_.size());
+    std::vector<double> term_freqs(document_ids.size());
+    for (size_t block_index = 0; block_index < blocks_.size(); ++block_index) {
+        DecodeBlock(block_index, document_ids.data() + block_index * BLOCK_SIZE, term_freqs.data() + block_index * BLOCK_SIZE);
+    }
+    std::copy(document_ids_.begin(), document_ids_.end(), document_ids.begin() + GetCompressedSize());
+    std::copy(term_freqs_.begin(), term_freqs_.end(), term_freqs.begin() + GetCompressedSize());
+    document_ids_ = std::move(document_ids);
+    term_freqs_ = std::move(term_freqs);
+    blocks_.clear();
+    block_storage_.reset();
+}
+
+void PostingList::Pack() {
+    if (format_ != PostingFormat::COMPRESSED || document_ids_.size() < BLOCK_SIZE) {
+        return;
+    }
+    const size_t packed_count = document_ids_.size() / BLOCK_SIZE * BLOCK_SIZE;
+    for (size_t i = 0; i < packed_count; i += BLOCK_SIZE) {
+        AppendBlock(document_ids_.data() + i, term_freqs_.data() + i);
+    }
+    document_ids_.erase(document_ids_.begin(), document_ids_.begin() + packed_count);
+    term_freqs_.erase(term_freqs_.begin(), term_freqs_.begin() + packed_count);
+    // Ёмкости на один неполный блок хватает для дописывания; больше остаётся только после распаковки всего списка
+    if (document_ids_.capacity() > BLOCK_SIZE) {
+        document_ids_.shrink_to_fit();
+        term_freqs_.shrink_to_fit();
+    }
+}
+
+void PostingList::DetachExternal() {
+    if (external_document_ids_ == nullptr) {
+        return;
+    }
+    document_ids_.assign(external_document_ids_, external_document_ids_ + external_size_);
+    term_freqs_.assign(external_term_freqs_, external_term_freqs_ + external_size_);
+    external_document_ids_ = nullptr;
+    external_term_freqs_ = nullptr;
+    external_size_ = 0;
+}
+
+void PostingList::MergeTail() {
+    Unpack();
+    std::vector<int> document_ids;
+    std::vector<double> term_freqs;
+    document_ids.reserve(size());
+    term_freqs.reserve(size());
+
+    size_t main_pos = 0;
+    size_t tail_pos = 0;
+    while (main_pos < document_ids_.size() || tail_pos < tail_document_ids_.size()) {
+        const bool take_main = tail_pos == tail_document_ids_.size()
+            || (main_pos < document_ids_.size() && document_ids_[main_pos] < tail_document_ids_[tail_pos]);
+        if (take_main) {
+            document_ids.push_back(document_ids_[main_pos]);
+            term_freqs.push_back(term_freqs_[main_pos++]);
+        } else {
+            document_ids.push_back(tail_document_ids_[tail_pos]);
+            term_freqs.push_back(tail_term_freqs_[tail_pos++]);
+        }
+    }
+
+    document_ids_ = std::move(document_ids);
+    term_freqs_ = std::move(term_freqs);
+    tail_document_ids_.clear();
+    tail_term_freqs_.clear();
+    Pack();
+}
+
+size_t GallopLowerBound(const int* document_ids, size_t size, size_t from, int document_id) {
+    size_t step = 1;
+    size_t bound = from;
+    while (bound < size && document_ids[bound] < document_id) {
+        from = bound + 1;
+        bound += step;
+        step *= 2;
+    }
+    bound = std::min(bound, size);
+    return std::lower_bound(document_ids + from, document_ids + bound, document_id) - document_ids;
+}
\ No newline at end of file
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+// Представление основной части списков документов
+enum class PostingFormat {
+    // Массивы id и частот как есть
+    PLAIN,
+    // Блоки по PostingList::BLOCK_SIZE записей: разности соседних id и номера частот в таблице значений списка
+    // упакованы минимальным для блока числом бит. Частоты восстанавливаются точно, поэтому результаты поиска не меняются
+    COMPRESSED,
+};
+
+// Список документов одного термина в виде структуры массивов:
+// отсортированные id документов и параллельный массив частот термина.
+// Документы с растущими id дописываются в конец за O(1); остальные попадают
+// в небольшой отсортированный хвост, который сливается с основной частью при переполнении.
+// Основная часть может лежать в чужой памяти (например, в отображённом файле снимка):
+// тогда она копируется в собственные векторы только при первом изменении списка.
+// В формате COMPRESSED основная часть — сжатые блоки и неполный последний блок в обычных массивах.
+// Дописывание в конец по-прежнему O(1); остальные изменения распаковывают список и сжимают его заново
+class PostingList {
+public:
+    static constexpr size_t BLOCK_SIZE = 128;
+
+    PostingList() = default;
+
+    explicit PostingList(PostingFormat format);
+
+    PostingList(const PostingList& other);
+
+    PostingList(PostingList&& other) noexcept = default;
+
+    PostingList& operator=(const PostingList& other);
+
+    PostingList& operator=(PostingList&& other) noexcept = default;
+
+    // Список, основная часть которого читается из внешних массивов без копирования.
+    // Массивы должны жить дольше списка
+    static PostingList FromExternal(const int* document_ids, const double* term_freqs, size_t size, double max_term_freq);
+
+    // Если документ уже есть в списке, частоты складываются
+    void Add(int document_id, double term_freq);
+
+    // Возвращает false, если документа нет в списке
+    bool Remove(int document_id);
+
+    // Удаляет документы из отсортированного диапазона за один проход по списку и возвращает,
+    // сколько их было в списке. Опустевший список освобождает память
+    size_t RemoveSorted(const int* first, const int* last);
+
+    std::optional<double> FindTermFreq(int document_id) const;
+
+    bool Contains(int document_id) const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    // Оценка сверху для частоты термина в любом документе списка.
+    // После удаления документов может быть больше настоящего максимума
+    double GetMaxTermFreq() const;
+
+    PostingFormat GetFormat() const;
+
+    // Перестраивает основную часть в формате format
+    void SetFormat(PostingFormat format);
+
+    // Вызывает callback(document_id, term_freq) для каждого документа:
+    // сначала для основной части, затем для хвоста
+    template <typename Callback>
+    void ForEach(Callback callback) const;
+
+    // Вызывает callback(document_id, term_freq * idf) для каждого документа.
+    // Произведения считаются пачками в отдельном цикле, который компилятор векторизует
+    template <typename Callback>
+    void ForEachImpact(double idf, Callback callback) const;
+
+    // То же только для документов с id из [first_document_id, last_document_id).
+    // Блоки вне диапазона пропускаются по таблице пропусков без распаковки
+    template <typename Callback>
+    void ForEachImpactInRange(double idf, int first_document_id, int last_document_id, Callback callback) const;
+
+    // Проверяет вхождение документов, id которых не убывают от вызова к вызову.
+    // Поиск идёт галопом: позиция в списке только растёт, а шаг удваивается
+    class MonotoneLookup {
+    public:
+        explicit MonotoneLookup(const PostingList& postings);
+
+        bool Contains(int document_id);
+
+    private:
+        const PostingList* postings_;
+        size_t block_pos_ = 0;
+        // Позиция в распакованном блоке, а после всех блоков — в несжатой части
+        size_t main_pos_ = 0;
+        size_t tail_pos_ = 0;
+        // Распакованные id блока block_pos_, если decoded_block_ == block_pos_
+        size_t decoded_block_ = NO_BLOCK;
+        int block_ids_[BLOCK_SIZE];
+    };
+
+    size_t GetMemoryUsage() const;
+
+    // Обходит документы списка по возрастанию id и умеет перескакивать вперёд
+    class Cursor {
+    public:
+        explicit Cursor(const PostingList& postings);
+
+        bool AtEnd() const;
+
+        int GetDocumentId() const;
+
+        double GetTermFreq() const;
+
+        void Next();
+
+        // Переходит к первому документу с id не меньше document_id
+        void SeekTo(int document_id);
+
+        // Оценка сверху для частоты термина в документе document_id, если он не раньше курсора.
+        // В сжатом списке это максимум блока, куда попадает документ, а между блоками — ноль; иначе GetMaxTermFreq.
+        // Курсор не сдвигается и блок не распаковывается
+        double GetBlockMaxTermFreq(int document_id) const;
+
+    private:
+        const PostingList* postings_;
+        // Позиция в основной части: сначала сжатые блоки, затем обычные массивы
+        size_t main_pos_ = 0;
+        size_t tail_pos_ = 0;
+        // Распакованный блок, в котором стоит main_pos_
+        size_t decoded_block_ = NO_BLOCK;
+        int block_ids_[BLOCK_SIZE];
+        double block_freqs_[BLOCK_SIZE];
+
+        bool IsMainCurrent() const;
+
+        int GetMainDocumentId() const;
+
+        void DecodeCurrentBlock();
+    };
+
+private:
+    static constexpr size_t MAX_TAIL_SIZE = 64;
+    static constexpr size_t IMPACT_BATCH_SIZE = 256;
+    static constexpr size_t NO_BLOCK = static_cast<size_t>(-1);
+
+    // Запись таблицы пропусков: по ней блоки перескакиваются без распаковки
+    struct BlockInfo {
+        int first_document_id;
+        int last_document_id;
+        double max_term_freq;
+        // Начало блока в BlockStorage::data: упакованные разности id, затем номера частот в BlockStorage::freq_values
+        uint32_t offset;
+        uint8_t id_bits;
+        uint8_t freq_index_bits;
+    };
+
+    std::vector<int> document_ids_;
+    std::vector<double> term_freqs_;
+    std::vector<int> tail_document_ids_;
+    std::vector<double> tail_term_freqs_;
+    double max_term_freq_ = 0;
+    PostingFormat format_ = PostingFormat::PLAIN;
+    // Сжатые блоки идут перед обычной основной частью, и все id в них меньше
+    std::vector<BlockInfo> blocks_;
+    // Данные сжатых блоков. Вынесены из объекта, чтобы не увеличивать списки редких терминов,
+    // которые короче блока и никогда не сжимаются
+    struct BlockStorage {
+        std::vector<uint8_t> data;
+        // Различные частоты в порядке появления, чтобы номера не менялись при дописывании блоков.
+        // Частоты вида «число вхождений / длина документа» повторяются, и таких значений немного
+        std::vector<double> freq_values;
+        // Номера в freq_values, упорядоченные по значению, — для поиска номера частоты при сжатии
+        std::vector<uint32_t> freq_value_order;
+    };
+    std::unique_ptr<BlockStorage> block_storage_;
+
+    // Внешняя основная часть; если external_document_ids_ == nullptr, она в document_ids_ и term_freqs_
+    const int* external_document_ids_ = nullptr;
+    const double* external_term_freqs_ = nullptr;
+    size_t external_size_ = 0;
+
+    // Несжатая часть основной части
+    const int* GetMainIds() const;
+
+    const double* GetMainFreqs() const;
+
+    size_t GetMainSize() const;
+
+    size_t GetCompressedSize() const;
+
+    // Первый блок не раньше from, последний id которого не меньше document_id
+    size_t FindBlock(int document_id, size_t from) const;
+
+    void DecodeBlockIds(size_t block_index, int* document_ids) const;
+
+    void DecodeBlock(size_t block_index, int* document_ids, double* term_freqs) const;
+
+    double DecodeBlockTermFreq(size_t block_index, size_t position) const;
+
+    uint32_t GetFreqValueIndex(double term_freq);
+
+    void AppendBlock(const int* document_ids, const double* term_freqs);
+
+    // Распаковывает блоки в начало обычных массивов
+    void Unpack();
+
+    // В формате COMPRESSED сжимает полные блоки из начала обычных массивов
+    void Pack();
+
+    // Копирует внешнюю основную часть в собственные векторы перед изменением
+    void DetachExternal();
+
+    void MergeTail();
+
+    template <typename Callback>
+    static void ForEachImpact(const int* document_ids, const double* term_freqs, size_t count, double idf, Callback& callback);
+};
+
+// Первая позиция не меньше from, где id документа не меньше document_id
+size_t GallopLowerBound(const int* document_ids, size_t size, size_t from, int document_id);
+
+template <typename Callback>
+void PostingList::ForEach(Callback callback) const {
+    int block_ids[BLOCK_SIZE];
+    double block_freqs[BLOCK_SIZE];
+    for (size_t block_index = 0; block_index < blocks_.size(); ++block_index) {
+        DecodeBlock(block_index, block_ids, block_freqs);
+        for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+            callback(block_ids[i], block_freqs[i]);
+        }
+    }
+    const int* main_ids = GetMainIds();
+    const double* main_freqs = GetMainFreqs();
+    for (size_t i = 0; i < GetMainSize(); ++i) {
+        callback(main_ids[i], main_freqs[i]);
+    }
+    for (size_t i = 0; i < tail_document_ids_.size(); ++i) {
+        callback(tail_document_ids_[i], tail_term_freqs_[i]);
+    }
+}
+
+template <typename Callback>
+void PostingList::ForEachImpact(double idf, Callback callback) const {
+    int block_ids[BLOCK_SIZE];
+    double block_freqs[BLOCK_SIZE];
+    for (size_t block_index = 0; block_index < blocks_.size(); ++block_index) {
+        DecodeBlock(block_index, block_ids, block_freqs);
+        ForEachImpact(block_ids, block_freqs, BLOCK_SIZE, idf, callback);
+    }
+    ForEachImpact(GetMainIds(), GetMainFreqs(), GetMainSize(), idf, callback);
+    ForEachImpact(tail_document_ids_.data(), tail_term_freqs_.data(), tail_document_ids_.size(), idf, callback);
+}
+
+template <typename Callback>
+void PostingList::ForEachImpactInRange(double idf, int first_document_id, int last_document_id, Callback callback) const {
+    int block_ids[BLOCK_SIZE];
+    double block_freqs[BLOCK_SIZE];
+    for (size_t block_index = FindBlock(first_document_id, 0);
+         block_index < blocks_.size() && blocks_[block_index].first_document_id < last_document_id; ++block_index) {
+        DecodeBlock(block_index, block_ids, block_freqs);
+        const size_t first = std::lower_bound(block_ids, block_ids + BLOCK_SIZE, first_document_id) - block_ids;
+        const size_t last = std::lower_bound(block_ids + first, block_ids + BLOCK_SIZE, last_document_id) - block_ids;
+        ForEachImpact(block_ids + first, block_freqs + first, last - first, idf, callback);
+    }
+    const auto for_each_sorted = [&](const int* document_ids, const double* term_freqs, size_t count) {
+        const size_t first = std::lower_bound(document_ids, document_ids + count, first_document_id) - document_ids;
+        const size_t last = std::lower_bound(document_ids + first, document_ids + count, last_document_id) - document_ids;
+        ForEachImpact(document_ids + first, term_freqs + first, last - first, idf, callback);
+    };
+    for_each_sorted(GetMainIds(), GetMainFreqs(), GetMainSize());
+    for_each_sorted(tail_document_ids_.data(), tail_term_freqs_.data(), tail_document_ids_.size());
+}
+
+template <typename Callback>
+void PostingList::ForEachImpact(const int* document_ids, const double* term_freqs, size_t count, double idf, Callback& callback) {
+    double impacts[IMPACT_BATCH_SIZE];
+    for (size_t batch_begin = 0; batch_begin < count; batch_begin += IMPACT_BATCH_SIZE) {
+        const size_t batch_size = std::min(IMPACT_BATCH_SIZE, count - batch_begin);
+        const double* batch_freqs = term_freqs + batch_begin;
+        for (size_t i = 0; i < batch_size; ++i) {
+            impacts[i] = batch_freqs[i] * idf;
+        }
+        for (size_t i = 0; i < batch_size; ++i) {
+            callback(document_ids[batch_begin + i], impacts[i]);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "process_queries.h"
+#include <algorithm>
+#include <exception>
+#include <execution>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "document.h"
+#include "search_server.h"
+
+JoinedDocuments::JoinedDocuments(std::vector<std::vector<Document>> documents)
+    : documents_(std::move(documents))
+    , size_(std::transform_reduce(documents_.begin(), documents_.end(), size_t{0}, std::plus<>{},
+                                  [](const std::vector<Document>& page) { return page.size(); })) {
+}
+
+JoinedDocuments::Iterator JoinedDocuments::begin() const {
+    return Iterator(documents_.begin(), documents_.end());
+}
+
+JoinedDocuments::Iterator JoinedDocuments::end() const {
+    return Iterator(documents_.end(), documents_.end());
+}
+
+size_t JoinedDocuments::size() const {
+    return size_;
+}
+
+bool JoinedDocuments::empty() const {
+    return size_ == 0;
+}
+
+std::vector<std::vector<Document>> ProcessQueries(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries) {
+    std::vector<std::vector<Document>> documents_lists(queries.size());
+    // Исключение внутри параллельного алгоритма завершило бы программу, поэтому ошибка каждого запроса
+    // сохраняется, а первая из них выбрасывается после того, как обработаны все запросы
+    std::vector<std::exception_ptr> errors(queries.size());
+    std::vector<size_t> indexes(queries.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::for_each(std::execution::par, indexes.begin(), indexes.end(), [&](size_t i) {
+        try {
+            documents_lists[i] = search_server.FindTopDocuments(queries[i]);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    });
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return documents_lists;
+}
+
+JoinedDocuments ProcessQueriesJoined(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries) {
+    return JoinedDocuments(ProcessQueries(search_server, queries));
+}
\ No newline at end of file
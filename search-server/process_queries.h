@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "document.h"
+#include "search_server.h"
+
+// Результаты пачки запросов, склеенные в одну последовательность без копирования:
+// итератор проходит по вложенным векторам, пропуская пустые
+class JoinedDocuments {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Document;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Document*;
+        using reference = const Document&;
+
+        Iterator() = default;
+
+        Iterator(std::vector<std::vector<Document>>::const_iterator outer,
+                 std::vector<std::vector<Document>>::const_iterator outer_end)
+            : outer_(outer)
+            , outer_end_(outer_end) {
+            SkipEmpty();
+        }
+
+        reference operator*() const {
+            return (*outer_)[inner_];
+        }
+
+        pointer operator->() const {
+            return &(*outer_)[inner_];
+        }
+
+        Iterator& operator++() {
+            if (++inner_ == outer_->size()) {
+                ++outer_;
+                inner_ = 0;
+                SkipEmpty();
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return outer_ == other.outer_ && inner_ == other.inner_;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        std::vector<std::vector<Document>>::const_iterator outer_;
+        std::vector<std::vector<Document>>::const_iterator outer_end_;
+        size_t inner_ = 0;
+
+        void SkipEmpty() {
+            while (outer_ != outer_end_ && outer_->empty()) {
+                ++outer_;
+            }
+        }
+    };
+
+    explicit JoinedDocuments(std::vector<std::vector<Document>> documents);
+
+    Iterator begin() const;
+
+    Iterator end() const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+private:
+    std::vector<std::vector<Document>> documents_;
+    size_t size_ = 0;
+};
+
+// Выполняет запросы параллельно; i-й элемент ответа соответствует i-му запросу.
+// Если хотя бы один запрос некорректен, после выполнения всех запросов выбрасывается исключение первого из них
+std::vector<std::vector<Document>> ProcessQueries(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries);
+
+JoinedDocuments ProcessQueriesJoined(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries);
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "query_cache.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <string>
+#include "document_fingerprint.h"
+
+namespace {
+
+// Примерный объём записи: по нему бюджет памяти переводится в число записей для ширины скетча
+const size_t EXPECTED_ENTRY_SIZE = 256;
+const size_t MIN_SKETCH_WIDTH = 64;
+
+// Служебные поля узла списка и узла хеш-таблицы с ключом, итератором и указателем на следующий узел
+const size_t ENTRY_NODE_OVERHEAD = 2 * sizeof(void*) + sizeof(std::string_view) + 2 * sizeof(void*);
+
+}  // namespace
+
+FrequencySketch::FrequencySketch(size_t capacity) {
+    size_t width = MIN_SKETCH_WIDTH;
+    while (width < capacity) {
+        width *= 2;
+    }
+    counters_.assign(DEPTH * width, 0);
+    width_mask_ = width - 1;
+    sample_limit_ = 10 * width;
+}
+
+void FrequencySketch::Increment(uint64_t hash) {
+    for (size_t row = 0; row < DEPTH; ++row) {
+        uint8_t& counter = counters_[GetIndex(hash, row)];
+        counter = std::min<uint8_t>(counter + 1, MAX_COUNT);
+    }
+    if (++sample_count_ == sample_limit_) {
+        for (uint8_t& counter : counters_) {
+            counter /= 2;
+        }
+        sample_count_ /= 2;
+    }
+}
+
+int FrequencySketch::Estimate(uint64_t hash) const {
+    int estimate = MAX_COUNT;
+    for (size_t row = 0; row < DEPTH; ++row) {
+        estimate = std::min<int>(estimate, counters_[GetIndex(hash, row)]);
+    }
+    return estimate;
+}
+
+size_t FrequencySketch::GetIndex(uint64_t hash, size_t row) const {
+    return row * (width_mask_ + 1) + (MixHash(hash + row) & width_mask_);
+}
+
+QueryResultCache::QueryResultCache(const SearchServer& search_server, size_t memory_budget)
+    : search_server_(search_server)
+    , memory_budget_(memory_budget)
+    , sketch_(memory_budget / EXPECTED_ENTRY_SIZE)
+    , index_generation_(search_server.GetIndexGeneration()) {
+}
+
+std::vector<Document> QueryResultCache::FindTopDocuments(std::string_view raw_query, DocumentStatus status, size_t max_count) {
+    // Числа в начале ключа однозначно отделяются от слов запроса, в которых нет пробелов
+    std::string key = std::to_string(static_cast<int>(status)) + ' ' + std::to_string(max_count) + ' '
+        + search_server_.NormalizeQuery(raw_query);
+    const uint64_t hash = std::hash<std::string>{}(key);
+    const uint64_t index_generation = search_server_.GetIndexGeneration();
+    {
+        std::lock_guard guard(mutex_);
+        if (index_generation != index_generation_) {
+            if (!entries_.empty()) {
+                ++stats_.invalidations;
+            }
+            ClearEntries();
+            index_generation_ = index_generation;
+        }
+        sketch_.Increment(hash);
+        const auto entry_it = entry_by_key_.find(key);
+        if (entry_it != entry_by_key_.end()) {
+            ++stats_.hits;
+            entries_.splice(entries_.begin(), entries_, entry_it->second);
+            return entry_it->second->documents;
+        }
+        ++stats_.misses;
+    }
+
+    // Поиск идёт без блокировки: другие потоки тем временем обслуживаются из кеша
+    std::vector<Document> documents = search_server_.FindTopDocuments(raw_query, status, max_count);
+    std::lock_guard guard(mutex_);
+    if (index_generation == index_generation_ && entry_by_key_.count(key) == 0) {
+        Insert(std::move(key), hash, documents);
+    }
+    return documents;
+}
+
+QueryCacheStats QueryResultCache::GetStats() const {
+    std::lock_guard guard(mutex_);
+    return stats_;
+}
+
+void QueryResultCache::Clear() {
+    std::lock_guard guard(mutex_);
+    ClearEntries();
+}
+
+void QueryResultCache::ClearEntries() {
+    entry_by_key_.clear();
+    entries_.clear();
+    stats_.entry_count = 0;
+    stats_.memory_usage = 0;
+}
+
+void QueryResultCache::Insert(std::string key, uint64_t hash, const std::vector<Document>& documents) {
+    const size_t memory_usage = sizeof(Entry) + ENTRY_NODE_OVERHEAD + key.capacity() + documents.size() * sizeof(Document);
+    if (memory_usage > memory_budget_) {
+        ++stats_.rejections;
+        return;
+    }
+    const int frequency = sketch_.Estimate(hash);
+    while (stats_.memory_usage + memory_usage > memory_budget_) {
+        const auto victim_it = std::prev(entries_.end());
+        if (frequency <= sketch_.Estimate(victim_it->hash)) {
+            ++stats_.rejections;
+            return;
+        }
+        Erase(victim_it);
+        ++stats_.evictions;
+    }
+    entries_.push_front({std::move(key), hash, documents, memory_usage});
+    entry_by_key_.emplace(entries_.front().key, entries_.begin());
+    ++stats_.entry_count;
+    stats_.memory_usage += memory_usage;
+}
+
+void QueryResultCache::Erase(std::list<Entry>::iterator entry_it) {
+    stats_.memory_usage -= entry_it->memory_usage;
+    --stats_.entry_count;
+    entry_by_key_.erase(entry_it->key);
+    entries_.erase(entry_it);
+}
\ No newline at end of file
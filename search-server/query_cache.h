@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "document.h"
+#include "search_server.h"
+
+const size_t QUERY_CACHE_MEMORY_BUDGET = 16 * 1024 * 1024;
+
+// Счётчики кеша результатов поиска
+struct QueryCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    // Записи, вытесненные ради более частых запросов
+    size_t evictions = 0;
+    // Результаты, не попавшие в кеш, потому что их запрос встречался не чаще вытесняемого
+    size_t rejections = 0;
+    // Сбросы кеша из-за изменения индекса
+    size_t invalidations = 0;
+    // Запросы с предикатом, выполненные мимо кеша
+    size_t bypasses = 0;
+    size_t entry_count = 0;
+    size_t memory_usage = 0;
+};
+
+// Приблизительные счётчики обращений к ключам для допуска записей в кеш (TinyLFU): скетч Count-Min
+// с насыщающимися счётчиками. Когда обращений становится в 10 раз больше ширины скетча,
+// счётчики делятся пополам, чтобы давно популярные запросы не занимали кеш вечно
+class FrequencySketch {
+public:
+    // capacity — ожидаемое число записей кеша
+    explicit FrequencySketch(size_t capacity);
+
+    void Increment(uint64_t hash);
+
+    int Estimate(uint64_t hash) const;
+
+private:
+    static constexpr size_t DEPTH = 4;
+    static constexpr uint8_t MAX_COUNT = 15;
+
+    // DEPTH строк по width_mask_ + 1 счётчиков
+    std::vector<uint8_t> counters_;
+    size_t width_mask_ = 0;
+    size_t sample_count_ = 0;
+    size_t sample_limit_ = 0;
+
+    size_t GetIndex(uint64_t hash, size_t row) const;
+};
+
+// Кеш результатов FindTopDocuments поверх сервера: LRU, в который новая запись при нехватке памяти
+// допускается, только если её запрос встречается чаще вытесняемого (TinyLFU).
+// Ключ — канонический вид запроса, статус и число результатов, поэтому запросы, отличающиеся порядком слов,
+// повторами и стоп-словами, делят одну запись. Как только поколение индекса меняется, кеш сбрасывается целиком.
+// Методы можно вызывать из нескольких потоков, пока индекс не меняется
+class QueryResultCache {
+public:
+    explicit QueryResultCache(const SearchServer& search_server, size_t memory_budget = QUERY_CACHE_MEMORY_BUDGET);
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT);
+
+    // Результат предиката не сравнить между вызовами, поэтому такие запросы идут мимо кеша
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT) {
+        {
+            std::lock_guard guard(mutex_);
+            ++stats_.bypasses;
+        }
+        return search_server_.FindTopDocuments(raw_query, document_predicate, max_count);
+    }
+
+    QueryCacheStats GetStats() const;
+
+    void Clear();
+
+private:
+    struct Entry {
+        std::string key;
+        uint64_t hash;
+        std::vector<Document> documents;
+        size_t memory_usage;
+    };
+
+    const SearchServer& search_server_;
+    const size_t memory_budget_;
+    mutable std::mutex mutex_;
+    // В начале списка — последние использованные записи
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> entry_by_key_;
+    FrequencySketch sketch_;
+    uint64_t index_generation_;
+    QueryCacheStats stats_;
+
+    // Вызываются под mutex_
+    void ClearEntries();
+
+    void Insert(std::string key, uint64_t hash, const std::vector<Document>& documents);
+
+    void Erase(std::list<Entry>::iterator entry_it);
+};
\ No newline at end of file
@@ -1,6 +1,58 @@
 #include "read_input_functions.h"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <iostream>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+int ParseNumber(std::string_view text) {
+    int value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size() || text.empty()) {
+        throw std::invalid_argument("Некорректное число в строке документа: "s + std::string(text));
+    }
+    return value;
+}
+
+// Отрезает от line всё до первого разделителя и сам разделитель
+std::string_view TakeField(std::string_view& line, char separator) {
+    const size_t end = line.find(separator);
+    if (end == std::string_view::npos) {
+        throw std::invalid_argument("В строке документа не хватает полей"s);
+    }
+    const std::string_view field = line.substr(0, end);
+    line.remove_prefix(end + 1);
+    return field;
+}
+
+DocumentRecord ParseDocumentRecord(std::string_view line) {
+    DocumentRecord record;
+    record.id = ParseNumber(TakeField(line, '\t'));
+    const int status = ParseNumber(TakeField(line, '\t'));
+    if (status < static_cast<int>(DocumentStatus::ACTUAL) || status > static_cast<int>(DocumentStatus::REMOVED)) {
+        throw std::invalid_argument("Некорректный статус документа"s);
+    }
+    record.status = static_cast<DocumentStatus>(status);
+
+    std::string_view ratings = TakeField(line, '\t');
+    while (!ratings.empty()) {
+        const size_t end = std::min(ratings.find(' '), ratings.size());
+        if (end > 0) {
+            record.ratings.push_back(ParseNumber(ratings.substr(0, end)));
+        }
+        ratings.remove_prefix(std::min(end + 1, ratings.size()));
+    }
+    record.text = line;
+    return record;
+}
+
+}  // namespace
 
 std::string ReadLine() {
     std::string s;
@@ -13,4 +65,31 @@ int ReadLineWithNumber() {
     std::cin >> result;
     ReadLine();
     return result;
+}
+
+std::vector<DocumentRecord> ReadDocuments(std::istream& input, size_t max_count, size_t* bytes_read) {
+    std::vector<DocumentRecord> records;
+    std::string line;
+    while (records.size() < max_count && std::getline(input, line)) {
+        if (bytes_read != nullptr) {
+            *bytes_read += line.size() + 1;
+        }
+        if (!line.empty()) {
+            records.push_back(ParseDocumentRecord(line));
+        }
+    }
+    return records;
+}
+
+std::string FormatDocumentRecord(const DocumentRecord& record) {
+    std::string line = std::to_string(record.id) + '\t' + std::to_string(static_cast<int>(record.status)) + '\t';
+    for (size_t i = 0; i < record.ratings.size(); ++i) {
+        if (i > 0) {
+            line += ' ';
+        }
+        line += std::to_string(record.ratings[i]);
+    }
+    line += '\t';
+    line += record.text;
+    return line;
 }
\ No newline at end of file
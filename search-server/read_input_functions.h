@@ -2,7 +2,25 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include "document.h"
 
 std::string ReadLine();
 
-int ReadLineWithNumber();
\ No newline at end of file
+int ReadLineWithNumber();
+
+// Документ для пакетной загрузки. В потоке каждый документ занимает одну строку из четырёх полей,
+// разделённых табуляцией: id, статус числом, рейтинги через пробел (могут отсутствовать) и текст
+struct DocumentRecord {
+    int id = 0;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+    std::string text;
+};
+
+// Читает не больше max_count документов; пустые строки пропускаются.
+// bytes_read, если передан, увеличивается на число прочитанных байт
+std::vector<DocumentRecord> ReadDocuments(std::istream& input, size_t max_count, size_t* bytes_read = nullptr);
+
+// Строка в формате, который понимает ReadDocuments, без завершающего перевода строки
+std::string FormatDocumentRecord(const DocumentRecord& record);
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "relevance_accumulator.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+thread_local RelevanceAccumulator thread_accumulator;
+thread_local bool thread_accumulator_in_use = false;
+
+}  // namespace
+
+void RelevanceAccumulator::Reset(size_t ordinal_count, size_t expected_count) {
+    hash_mode_ = expected_count * HASH_MODE_RATIO < ordinal_count;
+
+    if (hash_mode_) {
+        for (const size_t slot : used_slots_) {
+            slot_ordinals_[slot] = EMPTY_SLOT;
+        }
+        used_slots_.clear();
+
+        // Заполненность таблицы не превышает половины
+        size_t capacity = 16;
+        while (capacity < expected_count * 2) {
+            capacity *= 2;
+        }
+        if (slot_ordinals_.size() < capacity) {
+            slot_ordinals_.assign(capacity, EMPTY_SLOT);
+            slot_scores_.resize(capacity);
+            slot_excluded_.resize(capacity);
+        }
+        slot_mask_ = std::min(capacity, slot_ordinals_.size()) - 1;
+        return;
+    }
+
+    touched_.clear();
+    if (scores_.size() < ordinal_count) {
+        scores_.resize(ordinal_count);
+        score_generations_.resize(ordinal_count, generation_);
+        excluded_generations_.resize(ordinal_count, generation_);
+    }
+    if (++generation_ == 0) {
+        // Счётчик поколений переполнился: старые метки могли совпасть с новыми
+        std::fill(score_generations_.begin(), score_generations_.end(), 0);
+        std::fill(excluded_generations_.begin(), excluded_generations_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+double RelevanceAccumulator::Add(int ordinal, double relevance) {
+    if (hash_mode_) {
+        const size_t slot = FindSlot(ordinal);
+        if (slot_ordinals_[slot] == EMPTY_SLOT) {
+            slot_ordinals_[slot] = static_cast<uint32_t>(ordinal);
+            slot_scores_[slot] = relevance;
+            slot_excluded_[slot] = false;
+            used_slots_.push_back(slot);
+        } else {
+            slot_scores_[slot] += relevance;
+        }
+        return slot_scores_[slot];
+    }
+
+    if (score_generations_[ordinal] != generation_) {
+        score_generations_[ordinal] = generation_;
+        scores_[ordinal] = relevance;
+        touched_.push_back(ordinal);
+    } else {
+        scores_[ordinal] += relevance;
+    }
+    return scores_[ordinal];
+}
+
+void RelevanceAccumulator::Exclude(int ordinal) {
+    if (hash_mode_) {
+        const size_t slot = FindSlot(ordinal);
+        if (slot_ordinals_[slot] != EMPTY_SLOT) {
+            slot_excluded_[slot] = true;
+        }
+        return;
+    }
+    excluded_generations_[ordinal] = generation_;
+}
+
+bool RelevanceAccumulator::IsHashMode() const {
+    return hash_mode_;
+}
+
+size_t RelevanceAccumulator::FindSlot(int ordinal) const {
+    // Мультипликативное хеширование Фибоначчи: соседние номера расходятся по таблице
+    size_t slot = (static_cast<uint64_t>(ordinal) * 11400714819323198485ull >> 32) & slot_mask_;
+    while (slot_ordinals_[slot] != EMPTY_SLOT && slot_ordinals_[slot] != static_cast<uint32_t>(ordinal)) {
+        slot = (slot + 1) & slot_mask_;
+    }
+    return slot;
+}
+
+ScopedRelevanceAccumulator::ScopedRelevanceAccumulator()
+    : accumulator_(&local_accumulator_)
+    , owns_thread_accumulator_(!thread_accumulator_in_use) {
+    if (owns_thread_accumulator_) {
+        thread_accumulator_in_use = true;
+        accumulator_ = &thread_accumulator;
+    }
+}
+
+ScopedRelevanceAccumulator::~ScopedRelevanceAccumulator() {
+    if (owns_thread_accumulator_) {
+        thread_accumulator_in_use = false;
+    }
+}
+
+RelevanceAccumulator& ScopedRelevanceAccumulator::operator*() {
+    return *accumulator_;
+}
+
+RelevanceAccumulator* ScopedRelevanceAccumulator::operator->() {
+    return accumulator_;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Копит релевантность документов по их порядковым номерам.
+// Два режима: плоский массив на всё пространство номеров со списком затронутых ячеек
+// и открытая хеш-таблица, когда документов с релевантностью ожидается мало.
+// Память переиспользуется между запросами: после прогрева запрос не выделяет памяти
+class RelevanceAccumulator {
+public:
+    // Хеш-таблица выбирается, если ожидаемых документов меньше чем ordinal_count / HASH_MODE_RATIO
+    static constexpr size_t HASH_MODE_RATIO = 16;
+
+    // Готовит аккумулятор к новому запросу. expected_count — оценка сверху
+    // числа документов, которые получат релевантность (сумма длин списков плюс-слов)
+    void Reset(size_t ordinal_count, size_t expected_count);
+
+    // Возвращает накопленную релевантность документа
+    double Add(int ordinal, double relevance);
+
+    // Исключает документ из результата, даже если релевантность для него уже накоплена
+    void Exclude(int ordinal);
+
+    // Вызывает callback(ordinal, relevance) для каждого неисключённого документа
+    template <typename Callback>
+    void ForEach(Callback callback) const;
+
+    bool IsHashMode() const;
+
+private:
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+    bool hash_mode_ = false;
+
+    // Плоский режим: ячейка действительна, только если её метка равна текущему поколению,
+    // поэтому между запросами массивы не нужно очищать
+    uint32_t generation_ = 0;
+    std::vector<double> scores_;
+    std::vector<uint32_t> score_generations_;
+    std::vector<uint32_t> excluded_generations_;
+    std::vector<int> touched_;
+
+    // Режим хеш-таблицы с линейным пробированием
+    std::vector<uint32_t> slot_ordinals_;
+    std::vector<double> slot_scores_;
+    std::vector<bool> slot_excluded_;
+    std::vector<size_t> used_slots_;
+    size_t slot_mask_ = 0;
+
+    size_t FindSlot(int ordinal) const;
+};
+
+// Выдаёт аккумулятор текущего потока. Если он уже занят выше по стеку вызовов
+// (например, предикат сам выполняет поиск), создаётся временный
+class ScopedRelevanceAccumulator {
+public:
+    ScopedRelevanceAccumulator();
+
+    ~ScopedRelevanceAccumulator();
+
+    ScopedRelevanceAccumulator(const ScopedRelevanceAccumulator&) = delete;
+    ScopedRelevanceAccumulator& operator=(const ScopedRelevanceAccumulator&) = delete;
+
+    RelevanceAccumulator& operator*();
+
+    RelevanceAccumulator* operator->();
+
+private:
+    RelevanceAccumulator* accumulator_;
+    bool owns_thread_accumulator_;
+    RelevanceAccumulator local_accumulator_;
+};
+
+template <typename Callback>
+void RelevanceAccumulator::ForEach(Callback callback) const {
+    if (hash_mode_) {
+        for (const size_t slot : used_slots_) {
+            if (!slot_excluded_[slot]) {
+                callback(static_cast<int>(slot_ordinals_[slot]), slot_scores_[slot]);
+            }
+        }
+        return;
+    }
+    for (const int ordinal : touched_) {
+        if (excluded_generations_[ordinal] != generation_) {
+            callback(ordinal, scores_[ordinal]);
+        }
+    }
+}
\ No newline at end of file
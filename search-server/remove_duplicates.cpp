@@ -1,26 +1,289 @@
 #include "remove_duplicates.h"
+#include "document_fingerprint.h"
 #include "search_server.h"
-#include <set>
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <execution>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
-void RemoveDuplicates(SearchServer& search_server) {
-    std::set<std::set<std::string>> unique_document_texts;
-    std::vector<int> documents_to_remove;
+using namespace std::literals;
+
+namespace {
+
+constexpr size_t MIN_HASH_COUNT = 128;
+// Подписи считаются порциями, чтобы не держать в памяти подписи всех документов сразу
+constexpr size_t SIGNATURE_CHUNK_SIZE = 1 << 16;
+// За столько документов вперёд запрашиваются ячейки корзин их полос
+constexpr size_t PREFETCH_DISTANCE = 4;
+
+// Корзины LSH: ключ полосы → оставленные документы с таким ключом. Открытая адресация и
+// односвязные списки в общем массиве: отдельный узел или вектор на каждый ключ слишком дороги.
+// Ключи — случайные хеши, поэтому младшие биты задают ячейку, а в ячейке хранятся только старшие 32 бита.
+// Совпадение меток разных ключей лишь добавляет кандидата, а кандидаты всё равно проверяются точно
+class BandBuckets {
+public:
+    explicit BandBuckets(size_t max_key_count) {
+        // Заполненность таблицы не превышает половины
+        size_t capacity = 1;
+        while (capacity < 2 * max_key_count) {
+            capacity *= 2;
+        }
+        slots_.assign(capacity, Slot{0, NO_ENTRY});
+    }
+
+    // Загружает ячейку ключа в кэш заранее: пробы разных полос друг от друга не зависят,
+    // и так их промахи кэша перекрываются
+    void Prefetch(uint64_t key) const {
+        __builtin_prefetch(&slots_[key & (slots_.size() - 1)]);
+    }
+
+    template <typename Consumer>
+    void ForEach(uint64_t key, Consumer consumer) const {
+        for (uint32_t entry = slots_[FindSlot(key)].head; entry != NO_ENTRY; entry = entries_[entry].next) {
+            consumer(entries_[entry].document_id);
+        }
+    }
+
+    void Add(uint64_t key, int document_id) {
+        Slot& slot = slots_[FindSlot(key)];
+        slot.tag = static_cast<uint32_t>(key >> 32);
+        entries_.push_back({document_id, slot.head});
+        slot.head = static_cast<uint32_t>(entries_.size() - 1);
+    }
+
+private:
+    static constexpr uint32_t NO_ENTRY = std::numeric_limits<uint32_t>::max();
+
+    // Пустая ячейка — та, где head == NO_ENTRY
+    struct Slot {
+        uint32_t tag;
+        uint32_t head;
+    };
+
+    struct Entry {
+        int document_id;
+        uint32_t next;
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<Entry> entries_;
 
+    size_t FindSlot(uint64_t key) const {
+        const uint32_t tag = static_cast<uint32_t>(key >> 32);
+        size_t slot = key & (slots_.size() - 1);
+        while (slots_[slot].head != NO_ENTRY && slots_[slot].tag != tag) {
+            slot = (slot + 1) & (slots_.size() - 1);
+        }
+        return slot;
+    }
+};
+
+template <typename ExecutionPolicy>
+std::vector<int> FindDuplicatesImpl(ExecutionPolicy&& policy, const SearchServer& search_server) {
+    std::vector<std::pair<DocumentFingerprint, int>> fingerprints;
+    fingerprints.reserve(search_server.GetDocumentCount());
     for (int document_id : search_server) {
-        const std::set<std::string> document_words = search_server.GetDocumentWordsById(document_id);
-        
-        // Если такой набор слов уже встречался, добавляем документ в список на удаление
-        if (unique_document_texts.count(document_words) > 0) {
-            documents_to_remove.push_back(document_id);
+        fingerprints.emplace_back(search_server.GetDocumentFingerprint(document_id), document_id);
+    }
+    // Внутри группы с одинаковым отпечатком документы идут по возрастанию id
+    std::sort(policy, fingerprints.begin(), fingerprints.end());
+
+    std::vector<std::pair<size_t, size_t>> groups;
+    for (size_t first = 0; first < fingerprints.size();) {
+        size_t last = first + 1;
+        while (last < fingerprints.size() && fingerprints[last].first == fingerprints[first].first) {
+            ++last;
+        }
+        if (last - first > 1) {
+            groups.emplace_back(first, last);
+        }
+        first = last;
+    }
+
+    // Совпадение отпечатков у разных наборов слов маловероятно, но возможно,
+    // поэтому документ считается повтором только после полного сравнения слов
+    std::vector<char> is_duplicate(fingerprints.size(), false);
+    std::for_each(policy, groups.begin(), groups.end(), [&](const std::pair<size_t, size_t>& group) {
+        std::vector<const std::vector<SearchServer::TermId>*> kept_terms;
+        for (size_t i = group.first; i < group.second; ++i) {
+            const std::vector<SearchServer::TermId>& document_terms = search_server.GetDocumentTermIds(fingerprints[i].second);
+            if (std::any_of(kept_terms.begin(), kept_terms.end(), [&document_terms](const auto* terms) {
+                    return *terms == document_terms;
+                })) {
+                is_duplicate[i] = true;
+            } else {
+                kept_terms.push_back(&document_terms);
+            }
+        }
+    });
+
+    std::vector<int> duplicates;
+    for (size_t i = 0; i < fingerprints.size(); ++i) {
+        if (is_duplicate[i]) {
+            duplicates.push_back(fingerprints[i].second);
+        }
+    }
+    std::sort(duplicates.begin(), duplicates.end());
+    return duplicates;
+}
+
+// Число строк в полосе LSH: пары с похожестью выше (1 / bands)^(1 / rows) почти наверняка
+// совпадают хотя бы в одной полосе. Берётся самое узкое сито, порог которого не выше заданного
+size_t ChooseRowsPerBand(double similarity_threshold) {
+    size_t rows_per_band = 1;
+    for (size_t rows = 2; rows <= MIN_HASH_COUNT; rows *= 2) {
+        const double bands = static_cast<double>(MIN_HASH_COUNT / rows);
+        if (std::pow(1.0 / bands, 1.0 / rows) > similarity_threshold) {
+            break;
+        }
+        rows_per_band = rows;
+    }
+    return rows_per_band;
+}
+
+// Ключи полос MinHash-подписи документа. i-я хеш-функция термина получается из двух базовых
+// хешей как h1 + i * h2 с одним дополнительным перемешиванием, чтобы подпись считалась быстро
+void ComputeBandKeys(const std::vector<SearchServer::TermId>& document_terms, size_t rows_per_band, uint64_t* band_keys) {
+    uint64_t signature[MIN_HASH_COUNT];
+    std::fill(std::begin(signature), std::end(signature), std::numeric_limits<uint64_t>::max());
+    for (const SearchServer::TermId term_id : document_terms) {
+        const uint64_t first_hash = MixHash(term_id);
+        const uint64_t second_hash = MixHash(first_hash) | 1;
+        for (size_t i = 0; i < MIN_HASH_COUNT; ++i) {
+            uint64_t hash = first_hash + i * second_hash;
+            hash = (hash ^ (hash >> 32)) * 0x9e3779b97f4a7c15ull;
+            signature[i] = std::min(signature[i], hash);
+        }
+    }
+    for (size_t band = 0; band < MIN_HASH_COUNT / rows_per_band; ++band) {
+        uint64_t key = MixHash(band);
+        for (size_t row = band * rows_per_band; row < (band + 1) * rows_per_band; ++row) {
+            key = MixHash(key ^ signature[row]);
+        }
+        band_keys[band] = key;
+    }
+}
+
+double ComputeJaccardSimilarity(const std::vector<SearchServer::TermId>& lhs, const std::vector<SearchServer::TermId>& rhs) {
+    if (lhs.empty() && rhs.empty()) {
+        return 1.0;
+    }
+    size_t common_count = 0;
+    for (auto lhs_it = lhs.begin(), rhs_it = rhs.begin(); lhs_it != lhs.end() && rhs_it != rhs.end();) {
+        if (*lhs_it < *rhs_it) {
+            ++lhs_it;
+        } else if (*rhs_it < *lhs_it) {
+            ++rhs_it;
         } else {
-            // В противном случае, добавляем этот набор слов в набор уже встреченных
-            unique_document_texts.insert(document_words);
+            ++common_count;
+            ++lhs_it;
+            ++rhs_it;
         }
     }
+    return static_cast<double>(common_count) / (lhs.size() + rhs.size() - common_count);
+}
+
+template <typename ExecutionPolicy>
+std::vector<int> FindNearDuplicatesImpl(ExecutionPolicy&& policy, const SearchServer& search_server, double similarity_threshold) {
+    if (!(similarity_threshold > 0.0 && similarity_threshold <= 1.0)) {
+        throw std::invalid_argument("Порог похожести должен быть в промежутке (0, 1]"s);
+    }
+    const size_t rows_per_band = ChooseRowsPerBand(similarity_threshold);
+    const size_t band_count = MIN_HASH_COUNT / rows_per_band;
+    const std::vector<int> document_ids(search_server.begin(), search_server.end());
+
+    // В корзинах лежат только оставленные документы, поэтому повтор повтора сравнивается с оригиналом.
+    // В каждой полосе не больше одного ключа на документ
+    BandBuckets buckets(document_ids.size() * band_count);
+    std::vector<int> duplicates;
+    std::vector<uint64_t> band_keys;
+    std::vector<const std::vector<SearchServer::TermId>*> chunk_terms;
+    std::vector<int> candidates;
+    for (size_t chunk_begin = 0; chunk_begin < document_ids.size(); chunk_begin += SIGNATURE_CHUNK_SIZE) {
+        const size_t chunk_end = std::min(document_ids.size(), chunk_begin + SIGNATURE_CHUNK_SIZE);
+        band_keys.resize((chunk_end - chunk_begin) * band_count);
+        chunk_terms.resize(chunk_end - chunk_begin);
+        std::vector<size_t> positions(chunk_end - chunk_begin);
+        std::iota(positions.begin(), positions.end(), 0);
+        std::for_each(policy, positions.begin(), positions.end(), [&](size_t position) {
+            chunk_terms[position] = &search_server.GetDocumentTermIds(document_ids[chunk_begin + position]);
+            ComputeBandKeys(*chunk_terms[position], rows_per_band, band_keys.data() + position * band_count);
+        });
 
-    // Удаляем документы, которые находятся в списке на удаление
-    for (int document_id : documents_to_remove) {
-        search_server.RemoveDocument(document_id);
+        for (size_t position = 0; position < positions.size(); ++position) {
+            const int document_id = document_ids[chunk_begin + position];
+            const uint64_t* document_band_keys = band_keys.data() + position * band_count;
+            if (position + PREFETCH_DISTANCE < positions.size()) {
+                for (size_t band = 0; band < band_count; ++band) {
+                    buckets.Prefetch(band_keys[(position + PREFETCH_DISTANCE) * band_count + band]);
+                }
+            }
+            candidates.clear();
+            for (size_t band = 0; band < band_count; ++band) {
+                buckets.ForEach(document_band_keys[band], [&candidates](int candidate_id) {
+                    candidates.push_back(candidate_id);
+                });
+            }
+            if (!candidates.empty()) {
+                std::sort(candidates.begin(), candidates.end());
+                candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+                const std::vector<SearchServer::TermId>& document_terms = *chunk_terms[position];
+                if (std::any_of(candidates.begin(), candidates.end(), [&](int candidate_id) {
+                        return ComputeJaccardSimilarity(document_terms, search_server.GetDocumentTermIds(candidate_id)) >= similarity_threshold;
+                    })) {
+                    duplicates.push_back(document_id);
+                    continue;
+                }
+            }
+            for (size_t band = 0; band < band_count; ++band) {
+                buckets.Add(document_band_keys[band], document_id);
+            }
+        }
     }
+    return duplicates;
+}
+
+}  // namespace
+
+std::vector<int> FindDuplicates(const SearchServer& search_server) {
+    return FindDuplicatesImpl(std::execution::seq, search_server);
 }
+
+std::vector<int> FindDuplicates(const std::execution::sequenced_policy& policy, const SearchServer& search_server) {
+    return FindDuplicatesImpl(policy, search_server);
+}
+
+std::vector<int> FindDuplicates(const std::execution::parallel_policy& policy, const SearchServer& search_server) {
+    return FindDuplicatesImpl(policy, search_server);
+}
+
+std::vector<int> FindNearDuplicates(const SearchServer& search_server, double similarity_threshold) {
+    return FindNearDuplicatesImpl(std::execution::seq, search_server, similarity_threshold);
+}
+
+std::vector<int> FindNearDuplicates(const std::execution::sequenced_policy& policy, const SearchServer& search_server,
+                                    double similarity_threshold) {
+    return FindNearDuplicatesImpl(policy, search_server, similarity_threshold);
+}
+
+std::vector<int> FindNearDuplicates(const std::execution::parallel_policy& policy, const SearchServer& search_server,
+                                    double similarity_threshold) {
+    return FindNearDuplicatesImpl(policy, search_server, similarity_threshold);
+}
+
+void RemoveDuplicates(SearchServer& search_server) {
+    search_server.RemoveDocuments(FindDuplicates(search_server));
+}
+
+void RemoveDuplicates(const std::execution::parallel_policy& policy, SearchServer& search_server) {
+    search_server.RemoveDocuments(policy, FindDuplicates(policy, search_server));
+}
+
+void RemoveNearDuplicates(SearchServer& search_server, double similarity_threshold) {
+    search_server.RemoveDocuments(FindNearDuplicates(search_server, similarity_threshold));
+}
\ No newline at end of file
@@ -1,5 +1,30 @@
 #pragma once
 
+#include <execution>
+#include <vector>
 #include "search_server.h"
 
-void RemoveDuplicates(SearchServer& search_server);
\ No newline at end of file
+// id документов, набор слов которых совпадает с набором слов документа с меньшим id, по возрастанию.
+// Документы группируются по отпечаткам, полное сравнение слов нужно только внутри группы
+std::vector<int> FindDuplicates(const SearchServer& search_server);
+
+std::vector<int> FindDuplicates(const std::execution::sequenced_policy& policy, const SearchServer& search_server);
+
+std::vector<int> FindDuplicates(const std::execution::parallel_policy& policy, const SearchServer& search_server);
+
+// id документов, у которых мера Жаккара наборов слов с каким-то оставленным документом с меньшим id
+// не меньше similarity_threshold. Кандидаты отбираются по MinHash-подписям через LSH, поэтому пара
+// с похожестью чуть выше порога изредка пропускается; найденные пары проверяются точно
+std::vector<int> FindNearDuplicates(const SearchServer& search_server, double similarity_threshold);
+
+std::vector<int> FindNearDuplicates(const std::execution::sequenced_policy& policy, const SearchServer& search_server,
+                                    double similarity_threshold);
+
+std::vector<int> FindNearDuplicates(const std::execution::parallel_policy& policy, const SearchServer& search_server,
+                                    double similarity_threshold);
+
+void RemoveDuplicates(SearchServer& search_server);
+
+void RemoveDuplicates(const std::execution::parallel_policy& policy, SearchServer& search_server);
+
+void RemoveNearDuplicates(SearchServer& search_server, double similarity_threshold);
\ No newline at end of file
@@ -1,33 +1,189 @@
 #include "request_queue.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
-#include <deque>
-#include <algorithm>
 #include "document.h"
 #include "search_server.h"
 
-    RequestQueue::RequestQueue(const SearchServer& server) : search_server(server) {
+    size_t GetLatencyBucketIndex(uint64_t nanoseconds) {
+        if (nanoseconds < LATENCY_SUB_BUCKET_COUNT) {
+            return nanoseconds;
+        }
+        const size_t exponent = 63 - __builtin_clzll(nanoseconds);
+        if (exponent > LATENCY_MAX_EXPONENT) {
+            return LATENCY_BUCKET_COUNT - 1;
+        }
+        const size_t sub_bucket = (nanoseconds >> (exponent - LATENCY_SUB_BUCKET_BITS)) & (LATENCY_SUB_BUCKET_COUNT - 1);
+        return (exponent - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKET_COUNT + sub_bucket;
+    }
+
+    uint64_t GetLatencyBucketUpperBound(size_t index) {
+        if (index < LATENCY_SUB_BUCKET_COUNT) {
+            return index;
+        }
+        const size_t exponent = index / LATENCY_SUB_BUCKET_COUNT + LATENCY_SUB_BUCKET_BITS - 1;
+        const uint64_t sub_bucket = index % LATENCY_SUB_BUCKET_COUNT;
+        return ((LATENCY_SUB_BUCKET_COUNT + sub_bucket + 1) << (exponent - LATENCY_SUB_BUCKET_BITS)) - 1;
+    }
+
+    RequestQueue::RequestQueue(const SearchServer& server, RequestWindow window)
+        : search_server(server)
+        , window_(window) {
+        if (window_.bucket_count == 0 || window_.duration.count() <= 0
+                || window_.duration.count() < static_cast<int64_t>(window_.bucket_count)) {
+            throw std::invalid_argument("Некорректное окно статистики запросов");
+        }
+        bucket_duration_ = window_.duration / window_.bucket_count;
+        buckets_.reset(new TimeBucket[window_.bucket_count]);
+        const uint64_t tick = GetTick(Clock::now());
+        for (uint64_t i = 0; i < window_.bucket_count && i <= tick; ++i) {
+            buckets_[(tick - i) % window_.bucket_count].tick.store(tick - i);
+        }
+        last_tick_.store(tick);
     }
     // сделаем "обёртки" для всех методов поиска, чтобы сохранять результаты для нашей статистики
-    std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentStatus status) {
-        return ManageRequest(search_server.FindTopDocuments(raw_query, status));
+    std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query, DocumentStatus status) {
+        const auto start = Clock::now();
+        auto documents = search_server.FindTopDocuments(raw_query, status);
+        return ManageRequest(std::move(documents), start);
     }
-    std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query) {
-        return ManageRequest(search_server.FindTopDocuments(raw_query));
+    std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query) {
+        const auto start = Clock::now();
+        auto documents = search_server.FindTopDocuments(raw_query);
+        return ManageRequest(std::move(documents), start);
     }
+
+    void RequestQueue::RecordRequest(size_t result_count, std::chrono::nanoseconds latency, Clock::time_point finish_time) {
+        const uint64_t tick = GetTick(finish_time);
+        AdvanceTo(tick);
+        TimeBucket& bucket = buckets_[tick % window_.bucket_count];
+        // Писатель сначала объявляет себя, потом сверяет номер, а обнуление меняет номер, потом ждёт писателей.
+        // Последовательная согласованность гарантирует, что хотя бы одна сторона увидит другую
+        bucket.writers.fetch_add(1, std::memory_order_seq_cst);
+        if (bucket.tick.load(std::memory_order_seq_cst) != tick) {
+            // Корзина такого запроса уже отдана более позднему времени или как раз обнуляется
+            bucket.writers.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        const uint64_t latency_ns = std::max<int64_t>(latency.count(), 0);
+
+        bucket.request_count.fetch_add(1, std::memory_order_relaxed);
+        bucket.result_count.fetch_add(result_count, std::memory_order_relaxed);
+        bucket.latencies[GetLatencyBucketIndex(latency_ns)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t max_latency = bucket.max_latency.load(std::memory_order_relaxed);
+        while (max_latency < latency_ns
+                && !bucket.max_latency.compare_exchange_weak(max_latency, latency_ns, std::memory_order_relaxed)) {
+        }
+        request_count_.fetch_add(1, std::memory_order_relaxed);
+        if (result_count == 0) {
+            bucket.no_result_count.fetch_add(1, std::memory_order_relaxed);
+            no_result_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        bucket.writers.fetch_sub(1, std::memory_order_release);
+    }
+
     int RequestQueue::GetNoResultRequests() const {
-        return std::count_if(requests_.begin(), requests_.end(), [](QueryResult res) {return !res.request_type;});
+        AdvanceTo(GetTick(Clock::now()));
+        // Сумма не бывает меньше нуля, но и при ошибке учёта не должна превращаться в отрицательное число
+        const uint64_t no_result_count = no_result_count_.load(std::memory_order_relaxed);
+        return static_cast<int>(std::min<uint64_t>(no_result_count, std::numeric_limits<int>::max()));
     }
 
-    std::vector<Document> RequestQueue::ManageRequest(const std::vector<Document>& documents) {
-        if (requests_.size() >= min_in_day_) {
-            requests_.pop_front();
+    RequestStats RequestQueue::GetStats() const {
+        AdvanceTo(GetTick(Clock::now()));
+        RequestStats stats;
+        std::vector<uint64_t> latencies(LATENCY_BUCKET_COUNT);
+        uint64_t max_latency = 0;
+        for (size_t i = 0; i < window_.bucket_count; ++i) {
+            const TimeBucket& bucket = buckets_[i];
+            stats.request_count += bucket.request_count.load(std::memory_order_relaxed);
+            stats.no_result_count += bucket.no_result_count.load(std::memory_order_relaxed);
+            stats.result_count += bucket.result_count.load(std::memory_order_relaxed);
+            max_latency = std::max(max_latency, bucket.max_latency.load(std::memory_order_relaxed));
+            for (size_t j = 0; j < LATENCY_BUCKET_COUNT; ++j) {
+                latencies[j] += bucket.latencies[j].load(std::memory_order_relaxed);
+            }
         }
-        if (!documents.empty()) {
-            requests_.push_back({true});
-        } else {
-            
-            requests_.push_back({false});
+        if (stats.request_count == 0) {
+            return stats;
         }
+        stats.no_result_rate = static_cast<double>(stats.no_result_count) / stats.request_count;
+        stats.average_result_count = static_cast<double>(stats.result_count) / stats.request_count;
+        stats.latency_max = std::chrono::nanoseconds(max_latency);
+
+        uint64_t histogram_total = 0;
+        for (uint64_t count : latencies) {
+            histogram_total += count;
+        }
+        const auto percentile = [&](double fraction) {
+            // Ранг берётся с округлением вверх: p99 из 100 запросов — самый медленный, а не предпоследний
+            const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * histogram_total + 0.999999));
+            uint64_t seen = 0;
+            for (size_t j = 0; j < LATENCY_BUCKET_COUNT; ++j) {
+                seen += latencies[j];
+                if (seen >= rank) {
+                    return std::chrono::nanoseconds(std::min(GetLatencyBucketUpperBound(j), max_latency));
+                }
+            }
+            return stats.latency_max;
+        };
+        stats.latency_p50 = percentile(0.50);
+        stats.latency_p95 = percentile(0.95);
+        stats.latency_p99 = percentile(0.99);
+        return stats;
+    }
+
+    const RequestWindow& RequestQueue::GetWindow() const {
+        return window_;
+    }
+
+    std::vector<Document> RequestQueue::ManageRequest(std::vector<Document> documents, Clock::time_point start) {
+        const auto finish = Clock::now();
+        RecordRequest(documents.size(), finish - start, finish);
         return documents;
+    }
+
+    uint64_t RequestQueue::GetTick(Clock::time_point time) const {
+        return static_cast<uint64_t>(time.time_since_epoch() / bucket_duration_);
+    }
+
+    void RequestQueue::AdvanceTo(uint64_t tick) const {
+        if (last_tick_.load(std::memory_order_acquire) >= tick) {
+            return;
+        }
+        std::lock_guard guard(advance_mutex_);
+        const uint64_t last = last_tick_.load(std::memory_order_relaxed);
+        if (last >= tick) {
+            return;
+        }
+        // После долгого простоя хватает одного прохода по всем корзинам
+        const uint64_t bucket_count = window_.bucket_count;
+        const uint64_t first = std::max(last + 1, tick >= bucket_count ? tick - bucket_count + 1 : 0);
+        for (uint64_t next = first; next <= tick; ++next) {
+            ExpireBucket(buckets_[next % bucket_count], next);
+        }
+        // Писатель, увидевший новый номер, пишет уже в обнулённую корзину. Писатели этого номера
+        // до публикации ждут на мьютексе и в корзину, пока она обнуляется, не попадают
+        last_tick_.store(tick, std::memory_order_release);
+    }
+
+    void RequestQueue::ExpireBucket(TimeBucket& bucket, uint64_t tick) const {
+        // Новые писатели отказываются от корзины, а начавшие запись дописывают её до обнуления
+        bucket.tick.store(EXPIRING_TICK, std::memory_order_seq_cst);
+        while (bucket.writers.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+        // Счётчики забираются обменом, а не обнуляются, поэтому суммы окна не расходятся с корзинами
+        request_count_.fetch_sub(bucket.request_count.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        no_result_count_.fetch_sub(bucket.no_result_count.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        bucket.result_count.store(0, std::memory_order_relaxed);
+        bucket.max_latency.store(0, std::memory_order_relaxed);
+        for (auto& count : bucket.latencies) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        bucket.tick.store(tick, std::memory_order_release);
     }
\ No newline at end of file
@@ -1,32 +1,116 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
-#include <deque>
-#include <algorithm>
+#include <string_view>
 #include "document.h"
 #include "search_server.h"
 
+// Окно статистики запросов: последние duration времени, разбитые на bucket_count корзин.
+// Корзина целиком выпадает из окна, когда её время истекает, поэтому граница окна точна до duration / bucket_count
+struct RequestWindow {
+    std::chrono::nanoseconds duration = std::chrono::hours(24);
+    size_t bucket_count = 96;
+};
+
+// Латентность с точностью около 6%: 16 линейных подкорзин на каждую степень двойки (как в HdrHistogram)
+const size_t LATENCY_SUB_BUCKET_BITS = 4;
+const size_t LATENCY_SUB_BUCKET_COUNT = 1 << LATENCY_SUB_BUCKET_BITS;
+// Всё, что дольше 2^40 нс (около 18 минут), попадает в последнюю корзину
+const size_t LATENCY_MAX_EXPONENT = 40;
+const size_t LATENCY_BUCKET_COUNT = (LATENCY_MAX_EXPONENT - LATENCY_SUB_BUCKET_BITS + 2) * LATENCY_SUB_BUCKET_COUNT;
+
+struct RequestStats {
+    uint64_t request_count = 0;
+    uint64_t no_result_count = 0;
+    uint64_t result_count = 0;
+    double no_result_rate = 0.0;
+    double average_result_count = 0.0;
+    std::chrono::nanoseconds latency_p50{0};
+    std::chrono::nanoseconds latency_p95{0};
+    std::chrono::nanoseconds latency_p99{0};
+    std::chrono::nanoseconds latency_max{0};
+};
+
+// Учёт поисковых запросов за скользящее окно времени. Можно вызывать из нескольких потоков одновременно:
+// запись — несколько атомарных инкрементов в корзину текущего момента, без блокировок.
+// Устаревшие корзины обнуляет под мьютексом тот поток, который первым заметил смену корзины, и только
+// потом публикует новый номер корзины. Поэтому запрос, записанный в окно, не теряется при его сдвиге.
+// Корзина помнит свой номер, а обнуление ждёт писателей, уже сверивших его: запрос с устаревшим номером
+// не попадает ни в обнуляемую корзину, ни в её следующий интервал.
+// Запросы, завершившиеся раньше начала окна, не учитываются
 class RequestQueue {
 public:
-    explicit RequestQueue(const SearchServer& server);
+    using Clock = std::chrono::steady_clock;
+
+    explicit RequestQueue(const SearchServer& server, RequestWindow window = {});
     // сделаем "обёртки" для всех методов поиска, чтобы сохранять результаты для нашей статистики
     template <typename DocumentPredicate>
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate) {
-        return ManageRequest(search_server.FindTopDocuments(raw_query, document_predicate));
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentPredicate document_predicate) {
+        const auto start = Clock::now();
+        auto documents = search_server.FindTopDocuments(raw_query, document_predicate);
+        return ManageRequest(std::move(documents), start);
     }
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentStatus status);
-    
-    std::vector<Document> AddFindRequest(const std::string& raw_query);
-    
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentStatus status);
+
+    std::vector<Document> AddFindRequest(std::string_view raw_query);
+
+    // Учитывает запрос, выполненный в обход очереди, например через ConcurrentSearchServer
+    void RecordRequest(size_t result_count, std::chrono::nanoseconds latency, Clock::time_point finish_time = Clock::now());
+
+    // Число запросов без результатов в окне, O(1)
     int GetNoResultRequests() const;
+
+    RequestStats GetStats() const;
+
+    const RequestWindow& GetWindow() const;
 private:
-    struct QueryResult {
-        bool request_type;
+    // Номер корзины, пока она обнуляется
+    static constexpr uint64_t EXPIRING_TICK = UINT64_MAX;
+
+    struct TimeBucket {
+        // Номер корзины, к которому относятся счётчики
+        std::atomic<uint64_t> tick{EXPIRING_TICK};
+        // Писатели, сверившие номер и ещё не закончившие запись
+        std::atomic<uint32_t> writers{0};
+        std::atomic<uint64_t> request_count{0};
+        std::atomic<uint64_t> no_result_count{0};
+        std::atomic<uint64_t> result_count{0};
+        std::atomic<uint64_t> max_latency{0};
+        std::array<std::atomic<uint32_t>, LATENCY_BUCKET_COUNT> latencies{};
     };
-    std::deque<QueryResult> requests_;
-    const static int min_in_day_ = 1440;
+
     const SearchServer& search_server;
-    
-    std::vector<Document> ManageRequest(const std::vector<Document>& documents);
-};
\ No newline at end of file
+    RequestWindow window_;
+    std::chrono::nanoseconds bucket_duration_;
+    std::unique_ptr<TimeBucket[]> buckets_;
+    // Номер корзины последнего учтённого момента времени; все корзины старше окна уже обнулены
+    mutable std::atomic<uint64_t> last_tick_;
+    // Сдвиг окна бывает раз в корзину, поэтому блокировка на нём не мешает записи
+    mutable std::mutex advance_mutex_;
+    // Суммы по всем корзинам окна, чтобы не обходить их на каждый вопрос о числе пустых запросов
+    mutable std::atomic<uint64_t> request_count_{0};
+    mutable std::atomic<uint64_t> no_result_count_{0};
+
+    std::vector<Document> ManageRequest(std::vector<Document> documents, Clock::time_point start);
+
+    uint64_t GetTick(Clock::time_point time) const;
+
+    // Сдвигает окно до корзины tick, обнуляя вышедшие из него корзины
+    void AdvanceTo(uint64_t tick) const;
+
+    // Обнуляет корзину и отдаёт её номеру tick
+    void ExpireBucket(TimeBucket& bucket, uint64_t tick) const;
+};
+
+size_t GetLatencyBucketIndex(uint64_t nanoseconds);
+
+// Наибольшая латентность, попадающая в корзину index
+uint64_t GetLatencyBucketUpperBound(size_t index);
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "scratch_arena.h"
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace {
+
+// Считает обращения монотонного ресурса к куче за блоками сверх буфера
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocation_count = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocation_count;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+struct ThreadScratchArena {
+    std::unique_ptr<std::byte[]> buffer = std::make_unique<std::byte[]>(SCRATCH_ARENA_INITIAL_SIZE);
+    size_t buffer_size = SCRATCH_ARENA_INITIAL_SIZE;
+    CountingResource upstream;
+    std::optional<std::pmr::monotonic_buffer_resource> resource{std::in_place, buffer.get(), buffer_size, &upstream};
+    size_t depth = 0;
+    ScratchArenaStats stats;
+
+    void Reset() {
+        resource->release();
+        ++stats.resets;
+        if (upstream.allocation_count == 0) {
+            return;
+        }
+        stats.overflow_allocations += upstream.allocation_count;
+        upstream.allocation_count = 0;
+        if (buffer_size >= SCRATCH_ARENA_MAX_SIZE) {
+            return;
+        }
+        // Буфер нельзя заменить под работающим монотонным ресурсом, поэтому ресурс создаётся заново
+        resource.reset();
+        buffer_size *= 2;
+        buffer = std::make_unique<std::byte[]>(buffer_size);
+        resource.emplace(buffer.get(), buffer_size, &upstream);
+    }
+};
+
+thread_local ThreadScratchArena thread_arena;
+
+}  // namespace
+
+ScratchScope::ScratchScope() {
+    ++thread_arena.depth;
+}
+
+ScratchScope::~ScratchScope() {
+    if (--thread_arena.depth == 0) {
+        thread_arena.Reset();
+    }
+}
+
+std::pmr::memory_resource* GetScratchResource() {
+    if (thread_arena.depth == 0) {
+        return std::pmr::new_delete_resource();
+    }
+    return &*thread_arena.resource;
+}
+
+ScratchArenaStats GetScratchArenaStats() {
+    ScratchArenaStats stats = thread_arena.stats;
+    stats.buffer_size = thread_arena.buffer_size;
+    return stats;
+}
\ No newline at end of file
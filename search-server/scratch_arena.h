@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+// Начальный размер буфера временной памяти запроса в каждом потоке
+const size_t SCRATCH_ARENA_INITIAL_SIZE = 16 * 1024;
+// Дальше буфер не растёт: редкие огромные запросы берут недостающее из кучи
+const size_t SCRATCH_ARENA_MAX_SIZE = 1024 * 1024;
+
+// Временная память запроса в текущем потоке: разбор запроса, списки терминов, курсоры.
+// Выделение — сдвиг указателя в буфере потока; освобождения нет, весь буфер сбрасывается,
+// когда завершается внешний ScratchScope. Если запросу не хватило буфера, при сбросе он удваивается
+// до SCRATCH_ARENA_MAX_SIZE, так что со временем запросы перестают обращаться к куче
+class ScratchScope {
+public:
+    ScratchScope();
+
+    ~ScratchScope();
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+};
+
+// Ресурс временной памяти потока внутри ScratchScope; вне его — обычная куча,
+// чтобы память, взятая без области, не копилась до следующего сброса
+std::pmr::memory_resource* GetScratchResource();
+
+struct ScratchArenaStats {
+    // Сбросы буфера, то есть завершённые внешние области
+    size_t resets = 0;
+    // Обращения к куче за дополнительными блоками, когда буфера не хватило
+    size_t overflow_allocations = 0;
+    size_t buffer_size = 0;
+};
+
+// Счётчики буфера текущего потока
+ScratchArenaStats GetScratchArenaStats();
\ No newline at end of file
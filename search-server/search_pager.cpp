@@ -0,0 +1,34 @@
+#include "search_pager.h"
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+SearchPager::SearchPager(const SearchServer& search_server, std::string_view raw_query, DocumentStatus status, size_t page_size)
+    : search_server_(search_server)
+    , raw_query_(raw_query)
+    , status_(status)
+    , page_size_(page_size) {
+    if (page_size_ == 0) {
+        throw std::invalid_argument("Размер страницы должен быть положительным"s);
+    }
+}
+
+std::vector<Document> SearchPager::GetPage(size_t page_index) {
+    std::vector<Document> page;
+    if (const auto previous_end = page_ends_.find(page_index - 1); page_index > 0 && previous_end != page_ends_.end()) {
+        page = search_server_.FindTopDocumentsAfter(raw_query_, status_, previous_end->second, page_size_);
+    } else {
+        page = search_server_.FindTopDocumentsPage(raw_query_, status_, page_index, page_size_);
+    }
+    if (page.size() == page_size_) {
+        page_ends_[page_index] = page.back();
+    }
+    return page;
+}
+
+size_t SearchPager::GetPageSize() const {
+    return page_size_;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "document.h"
+#include "search_server.h"
+
+// Постраничная выдача одного запроса без материализации предыдущих страниц.
+// Следующая страница продолжает предыдущую от её последнего документа (search-after по релевантности,
+// рейтингу и id), поэтому для страницы N отбираются и сортируются только page_size документов.
+// К странице, конец предыдущей которой ещё неизвестен, пейджер переходит одним проходом FindTopDocumentsPage.
+// Если индекс меняется между страницами, выдача продолжается от того же места без повторов
+class SearchPager {
+public:
+    SearchPager(const SearchServer& search_server, std::string_view raw_query, DocumentStatus status, size_t page_size);
+
+    // Страница page_index (с нуля); за последней страницей — пустой вектор
+    std::vector<Document> GetPage(size_t page_index);
+
+    size_t GetPageSize() const;
+
+private:
+    const SearchServer& search_server_;
+    std::string raw_query_;
+    DocumentStatus status_;
+    size_t page_size_;
+    // Последний документ каждой полученной полной страницы
+    std::map<size_t, Document> page_ends_;
+};
\ No newline at end of file
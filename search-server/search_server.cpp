@@ -1,114 +1,687 @@
 #include "search_server.h"  
 #include <string>  
+#include <string_view>  
 #include <vector>  
 #include <set>  
 #include <map>  
 #include <stdexcept>  
 #include <algorithm>  
+#include <atomic>  
+#include <chrono>  
 #include <cmath>  
 #include <iterator>  
+#include <execution>  
+#include <functional>  
+#include <exception>  
+#include <numeric>  
+#include <thread>  
+#include <unordered_map>  
 #include "document.h"  
 #include "string_processing.h"  
-#include "log_duration.h"  
+#include "posting_list.h"  
+#include "relevance_accumulator.h"  
+#include "snapshot.h"  
+#include "term_dictionary.h"  
  
 using namespace std::literals;  
  
-SearchServer::SearchServer(const std::string& stop_words_text)  
-    : SearchServer(SplitIntoWords(stop_words_text))  // Invoke delegating constructor from string container  
+namespace {  
+ 
+// Служебные поля узла красно-чёрного дерева: цвет и три указателя  
+const size_t RB_TREE_NODE_OVERHEAD = 4 * sizeof(void*);  
+ 
+template <typename Map>  
+size_t ComputeMapMemoryUsage(const Map& map) {  
+    return map.size() * (RB_TREE_NODE_OVERHEAD + sizeof(typename Map::value_type));  
+}  
+ 
+}  // namespace  
+ 
+size_t CollectionStatistics::GetDocumentFreq(std::string_view word) const {  
+    const auto it = document_freqs.find(word);  
+    return it == document_freqs.end() ? 0 : it->second;  
+}  
+ 
+SearchServer::SearchServer(const std::string& stop_words_text, IndexAllocation allocation)  
+    : SearchServer(std::string_view(stop_words_text), allocation)  
 {  
 }  
  
-void SearchServer::AddDocument(int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings) {  
-    LogDuration("AddDocument");  
-    const std::vector<std::string> words = SplitIntoWordsNoStop(document);  
+SearchServer::SearchServer(std::string_view stop_words_text, IndexAllocation allocation)  
+    : SearchServer(SplitIntoWords(stop_words_text), allocation)  // Invoke delegating constructor from string container  
+{  
+}  
+ 
+void SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {  
+    const std::vector<std::string_view> words = SplitIntoWordsNoStop(document);  
     if (documents_.count(document_id) != 0 || document_id < 0) {  
         throw std::invalid_argument("Некорректный id документа"s);  
     }  
     const double inv_word_count = 1.0 / words.size();  
-    for (const std::string& word : words) {  
-        word_to_document_freqs_[word][document_id] += inv_word_count;  
-        words_to_documents_[document_id].insert(word);  
+    const int ordinal = static_cast<int>(ordinal_to_document_id_.size());  
+    const int rating = ComputeAverageRating(ratings);  
+    AppendOrdinal(document_id, rating, status);  
+    std::vector<TermId>& document_terms = ordinal_to_terms_[ordinal];  
+    document_terms.reserve(words.size());  
+    for (std::string_view word : words) {  
+        document_terms.push_back(terms_.Intern(word));  
     }  
-    documents_.emplace(document_id, DocumentData{ComputeAverageRating(ratings), status});  
+    term_to_document_freqs_.resize(terms_.GetTermCount(), PostingList(posting_format_));  
+    term_log_document_freqs_.resize(terms_.GetTermCount());  
+ 
+    // После сортировки повторы слова идут подряд, и длина серии — число его вхождений  
+    std::sort(document_terms.begin(), document_terms.end());  
+    for (auto term_it = document_terms.begin(); term_it != document_terms.end();) {  
+        const auto term_end = std::upper_bound(term_it, document_terms.end(), *term_it);  
+        term_to_document_freqs_[*term_it].Add(ordinal, (term_end - term_it) * inv_word_count);  
+        UpdateTermStatistics(*term_it);  
+        term_it = term_end;  
+    }  
+    document_terms.erase(std::unique(document_terms.begin(), document_terms.end()), document_terms.end());  
+    document_terms.shrink_to_fit();  
+    documents_.emplace(document_id, DocumentData{rating, status, ordinal, ComputeFingerprint(document_terms)});  
     documents_id_.insert(document_id);  
+    UpdateDocumentCountStatistics();  
+    index_generation_ = NewIndexGeneration();  
+}  
+ 
+void SearchServer::AddDocuments(const std::vector<DocumentRecord>& records) {  
+    std::set<int> batch_ids;  
+    for (const DocumentRecord& record : records) {  
+        if (record.id < 0 || documents_.count(record.id) != 0 || !batch_ids.insert(record.id).second) {  
+            throw std::invalid_argument("Некорректный id документа"s);  
+        }  
+    }  
+    if (records.empty()) {  
+        return;  
+    }  
+ 
+    // Исключение внутри параллельного алгоритма завершило бы программу, поэтому ошибки разбора  
+    // сохраняются и выбрасываются после того, как все части пакета обработаны  
+    const size_t part_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, records.size());  
+    std::vector<PartialIndex> partial_indexes(part_count);  
+    std::vector<std::exception_ptr> errors(part_count);  
+    std::vector<size_t> parts(part_count);  
+    std::iota(parts.begin(), parts.end(), 0);  
+    std::for_each(std::execution::par, parts.begin(), parts.end(), [&](size_t part) {  
+        try {  
+            partial_indexes[part] = BuildPartialIndex(records, records.size() * part / part_count,  
+                                                      records.size() * (part + 1) / part_count);  
+        } catch (...) {  
+            errors[part] = std::current_exception();  
+        }  
+    });  
+    for (const std::exception_ptr& error : errors) {  
+        if (error) {  
+            std::rethrow_exception(error);  
+        }  
+    }  
+ 
+    const int first_ordinal = static_cast<int>(ordinal_to_document_id_.size());  
+    for (size_t i = 0; i < records.size(); ++i) {  
+        const DocumentRecord& record = records[i];  
+        const int rating = ComputeAverageRating(record.ratings);  
+        AppendOrdinal(record.id, rating, record.status);  
+        // Отпечаток документа посчитан в частичном индексе и записывается в MergePartialIndex  
+        documents_.emplace(record.id, DocumentData{rating, record.status, first_ordinal + static_cast<int>(i), DocumentFingerprint{}});  
+        documents_id_.insert(record.id);  
+    }  
+    // Части сливаются по порядку, поэтому номера документов в каждом списке растут и дописываются в конец  
+    for (const PartialIndex& partial_index : partial_indexes) {  
+        MergePartialIndex(partial_index, records, first_ordinal);  
+    }  
+    // Пакет обычно затрагивает большую часть словаря, поэтому логарифмы пересчитываются для всех терминов  
+    UpdateAllTermStatistics();  
+    index_generation_ = NewIndexGeneration();  
+}  
+ 
+SearchServer::BulkLoadStats SearchServer::AddDocuments(std::istream& input, size_t batch_size) {  
+    BulkLoadStats stats;  
+    for (std::vector<DocumentRecord> records = ReadDocuments(input, batch_size, &stats.byte_count); !records.empty();  
+         records = ReadDocuments(input, batch_size, &stats.byte_count)) {  
+        AddDocuments(records);  
+        stats.document_count += records.size();  
+    }  
+    return stats;  
 }  
  
-std::set<std::string> SearchServer::GetDocumentWordsById(int document_id) const {   
-    static std::set<std::string> empty_set;  // Статическая переменная для пустого множества
-    if (words_to_documents_.count(document_id)) {   
-        return words_to_documents_.at(document_id);   
+std::set<std::string_view> SearchServer::GetDocumentWordsById(int document_id) const {   
+    std::set<std::string_view> words;  
+    for (const TermId term_id : GetDocumentTermIds(document_id)) {  
+        words.insert(terms_.GetTerm(term_id));  
+    }  
+    return words;  
+} 
+ 
+const std::vector<SearchServer::TermId>& SearchServer::GetDocumentTermIds(int document_id) const {   
+    static const std::vector<TermId> empty_terms;  // Статическая переменная для пустого списка
+    const auto document_it = documents_.find(document_id);  
+    if (document_it != documents_.end()) {   
+        return ordinal_to_terms_[document_it->second.ordinal];   
     } else {   
-        return empty_set;  // Возвращаем статическое пустое множество
+        return empty_terms;  // Возвращаем статический пустой список
     }   
 } 
  
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& raw_query, DocumentStatus status) const {  
+DocumentFingerprint SearchServer::GetDocumentFingerprint(int document_id) const {  
+    return documents_.at(document_id).fingerprint;  
+}  
+ 
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status, size_t max_count,  
+                                                     QueryEvaluation evaluation, PruningStats* stats) const {  
+    if (evaluation == QueryEvaluation::EXHAUSTIVE) {  
+        switch (status) {  
+            case DocumentStatus::ACTUAL:  
+                return FindTopDocuments(raw_query, StatusFilter<DocumentStatus::ACTUAL>{}, max_count);  
+            case DocumentStatus::IRRELEVANT:  
+                return FindTopDocuments(raw_query, StatusFilter<DocumentStatus::IRRELEVANT>{}, max_count);  
+            case DocumentStatus::BANNED:  
+                return FindTopDocuments(raw_query, StatusFilter<DocumentStatus::BANNED>{}, max_count);  
+            case DocumentStatus::REMOVED:  
+                return FindTopDocuments(raw_query, StatusFilter<DocumentStatus::REMOVED>{}, max_count);  
+        }  
+    }  
     return FindTopDocuments(  
         raw_query, [status]([[maybe_unused]] int document_id, DocumentStatus document_status, [[maybe_unused]] int rating) {  
             return document_status == status;  
-        });  
+        }, max_count, evaluation, stats);  
+}  
+ 
+std::vector<Document> SearchServer::FindTopDocumentsAfter(std::string_view raw_query, DocumentStatus status, const Document& after,  
+                                                          size_t max_count) const {  
+    TopDocuments top_documents(max_count, after);  
+    CollectTopDocuments(raw_query, status, top_documents);  
+    return top_documents.Extract();  
+}  
+ 
+std::vector<Document> SearchServer::FindTopDocumentsPage(std::string_view raw_query, DocumentStatus status, size_t page_index,  
+                                                         size_t page_size) const {  
+    // Страница за пределами корпуса пуста; заодно исключается переполнение (page_index + 1) * page_size  
+    if (page_size == 0 || page_index >= ordinal_to_document_id_.size() / page_size + 1) {  
+        ParseSearchQuery(raw_query);  
+        return {};  
+    }  
+    const size_t skipped_count = page_index * page_size;  
+    TopDocuments top_documents(skipped_count + page_size);  
+    CollectTopDocuments(raw_query, status, top_documents);  
+    const size_t found_count = top_documents.GetCount();  
+    if (found_count <= skipped_count) {  
+        return {};  
+    }  
+    return top_documents.ExtractTail(found_count - skipped_count);  
 }  
  
-std::set<int>::const_iterator  SearchServer::begin() {  
+void SearchServer::CollectTopDocuments(std::string_view raw_query, DocumentStatus status, TopDocuments& top_documents) const {  
+    ScratchScope scratch;  
+    const Query query = ParseSearchQuery(raw_query);  
+    if (status_bitmaps_[static_cast<size_t>(status)].Count() == 0) {  
+        return;  
+    }  
+    switch (status) {  
+        case DocumentStatus::ACTUAL:  
+            FindAllDocumentsFiltered(query, StatusFilter<DocumentStatus::ACTUAL>{}, top_documents);  
+            break;  
+        case DocumentStatus::IRRELEVANT:  
+            FindAllDocumentsFiltered(query, StatusFilter<DocumentStatus::IRRELEVANT>{}, top_documents);  
+            break;  
+        case DocumentStatus::BANNED:  
+            FindAllDocumentsFiltered(query, StatusFilter<DocumentStatus::BANNED>{}, top_documents);  
+            break;  
+        case DocumentStatus::REMOVED:  
+            FindAllDocumentsFiltered(query, StatusFilter<DocumentStatus::REMOVED>{}, top_documents);  
+            break;  
+    }  
+}  
+ 
+std::pmr::set<int>::const_iterator  SearchServer::begin() const {  
     return documents_id_.begin();  
 }  
  
-std::set<int>::const_iterator  SearchServer::end() {  
+std::pmr::set<int>::const_iterator  SearchServer::end() const {  
     return documents_id_.end();  
 }  
  
 void SearchServer::RemoveDocument(int document_id) {  
-    // Удаляем соответствующие слова из индекса  
-    for (auto& word : words_to_documents_[document_id]) {  
-        word_to_document_freqs_[word].erase(document_id);  
-    }  
- 
-    // Удаляем информацию о документе из words_to_documents_ и documents_id_  
-    words_to_documents_.erase(document_id);  
-    documents_id_.erase(document_id);  
+    RemoveDocuments(std::execution::seq, {document_id});  
+}  
  
-    // Удаляем информацию о документе из documents_  
-    documents_.erase(document_id);  
+void SearchServer::RemoveDocuments(const std::vector<int>& document_ids) {  
+    RemoveDocuments(std::execution::seq, document_ids);  
 }  
  
 int SearchServer::GetDocumentCount() const {  
     return documents_.size();  
 }  
  
-std::tuple<std::vector<std::string>, DocumentStatus> SearchServer::MatchDocument(const std::string& raw_query, int document_id) const {
-    const Query query = ParseQuery(raw_query);
+bool SearchServer::HasDocument(int document_id) const {  
+    return documents_.count(document_id) != 0;  
+}  
  
-    std::vector<std::string> matched_words;
-    for (const std::string& word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) > 0 && word_to_document_freqs_.at(word).count(document_id)) {
-            matched_words.push_back(word);
-        }
-    }
+const std::set<std::string, std::less<>>& SearchServer::GetStopWords() const {  
+    return stop_words_;  
+}  
  
-    for (const std::string& word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) > 0 && word_to_document_freqs_.at(word).count(document_id)) {
-            matched_words.clear();
-            break;
-        }
-    }
+uint64_t SearchServer::GetIndexGeneration() const {  
+    return index_generation_;  
+}  
  
-    return {matched_words, documents_.at(document_id).status};
-}
+IndexAllocation SearchServer::GetIndexAllocation() const {  
+    return index_resource_.GetAllocation();  
+}  
+ 
+std::string SearchServer::NormalizeQuery(std::string_view raw_query) const {  
+    ScratchScope scratch;  
+    const Query query = ParseSearchQuery(raw_query);  
+    std::string normalized_query;  
+    for (std::string_view word : query.plus_words) {  
+        normalized_query += word;  
+        normalized_query += ' ';  
+    }  
+    for (std::string_view word : query.minus_words) {  
+        normalized_query += '-';  
+        normalized_query += word;  
+        normalized_query += ' ';  
+    }  
+    if (!normalized_query.empty()) {  
+        normalized_query.pop_back();  
+    }  
+    return normalized_query;  
+}  
+ 
+SearchServer::IndexMemoryUsage SearchServer::GetMemoryUsage() const {  
+    IndexMemoryUsage usage;  
+    usage.term_dictionary = terms_.GetMemoryUsage();  
+ 
+    usage.inverted_index = term_to_document_freqs_.capacity() * sizeof(PostingList);  
+    for (const PostingList& document_freqs : term_to_document_freqs_) {  
+        usage.inverted_index += document_freqs.GetMemoryUsage();  
+    }  
+ 
+    usage.forward_index = ordinal_to_terms_.capacity() * sizeof(std::vector<TermId>);  
+    for (const std::vector<TermId>& document_terms : ordinal_to_terms_) {  
+        usage.forward_index += document_terms.capacity() * sizeof(TermId);  
+    }  
+ 
+    usage.documents = ComputeMapMemoryUsage(documents_)  
+        + documents_id_.size() * (RB_TREE_NODE_OVERHEAD + sizeof(int))  
+        + ordinal_to_document_id_.capacity() * sizeof(int)  
+        + ordinal_to_metadata_.capacity() * sizeof(DocumentMetadata);  
+    for (const OrdinalBitmap& status_bitmap : status_bitmaps_) {  
+        usage.documents += status_bitmap.GetMemoryUsage();  
+    }  
+    return usage;  
+}  
+ 
+void SearchServer::SetPostingFormat(PostingFormat format) {  
+    posting_format_ = format;  
+    for (PostingList& document_freqs : term_to_document_freqs_) {  
+        document_freqs.SetFormat(format);  
+    }  
+}  
+ 
+PostingFormat SearchServer::GetPostingFormat() const {  
+    return posting_format_;  
+}  
+ 
+std::vector<Document> SearchServer::ProfileFindTopDocuments(std::string_view raw_query, DocumentStatus status, QueryProfile& profile,  
+                                                            MetadataSource source, size_t max_count) const {  
+    using Clock = std::chrono::steady_clock;  
+    const auto elapsed_ns = [](Clock::time_point start) {  
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());  
+    };  
+    const auto get_metadata = [this, source](int ordinal) {  
+        if (source == MetadataSource::TABLES) {  
+            return ordinal_to_metadata_[ordinal];  
+        }  
+        const DocumentData& document_data = documents_.at(ordinal_to_document_id_[ordinal]);  
+        return DocumentMetadata{document_data.rating, document_data.status};  
+    };  
+    ScratchScope scratch;  
+    const Query query = ParseSearchQuery(raw_query);  
+ 
+    Clock::time_point stage_start = Clock::now();  
+    std::vector<std::pair<const PostingList*, double>> plus_document_freqs;  
+    size_t expected_document_count = 0;  
+    for (std::string_view word : query.plus_words) {  
+        if (const auto* document_freqs = FindWordDocumentFreqs(word)) {  
+            const double inverse_document_freq = source == MetadataSource::TABLES  
+                ? ComputeWordInverseDocumentFreq(query, word, *document_freqs)  
+                : std::log(GetDocumentCount() * 1.0 / document_freqs->size());  
+            plus_document_freqs.emplace_back(document_freqs, inverse_document_freq);  
+            expected_document_count += document_freqs->size();  
+        }  
+    }  
+    profile.idf_ns += elapsed_ns(stage_start);  
+ 
+    // Предикат проверяется для всех записей списков заранее, чтобы чтение статуса замерялось отдельно  
+    stage_start = Clock::now();  
+    std::vector<bool> is_matching;  
+    is_matching.reserve(expected_document_count);  
+    for (const auto& [document_freqs, inverse_document_freq] : plus_document_freqs) {  
+        document_freqs->ForEach([&](int ordinal, [[maybe_unused]] double term_freq) {  
+            is_matching.push_back(get_metadata(ordinal).status == status);  
+        });  
+    }  
+    profile.metadata_ns += elapsed_ns(stage_start);  
+ 
+    stage_start = Clock::now();  
+    ScopedRelevanceAccumulator document_to_relevance;  
+    document_to_relevance->Reset(ordinal_to_document_id_.size(), expected_document_count);  
+    size_t position = 0;  
+    for (const auto& [document_freqs, inverse_document_freq] : plus_document_freqs) {  
+        document_freqs->ForEachImpact(inverse_document_freq, [&](int ordinal, double impact) {  
+            if (is_matching[position++]) {  
+                document_to_relevance->Add(ordinal, impact);  
+            }  
+        });  
+    }  
+    for (std::string_view word : query.minus_words) {  
+        if (const auto* document_freqs = FindWordDocumentFreqs(word)) {  
+            document_freqs->ForEach([&document_to_relevance](int ordinal, [[maybe_unused]] double term_freq) {  
+                document_to_relevance->Exclude(ordinal);  
+            });  
+        }  
+    }  
+    std::vector<std::pair<int, double>> matched_ordinals;  
+    document_to_relevance->ForEach([&matched_ordinals](int ordinal, double relevance) {  
+        matched_ordinals.emplace_back(ordinal, relevance);  
+    });  
+    profile.accumulation_ns += elapsed_ns(stage_start);  
+ 
+    stage_start = Clock::now();  
+    std::vector<Document> matched_documents;  
+    matched_documents.reserve(matched_ordinals.size());  
+    for (const auto& [ordinal, relevance] : matched_ordinals) {  
+        matched_documents.push_back({ordinal_to_document_id_[ordinal], relevance, get_metadata(ordinal).rating});  
+    }  
+    profile.metadata_ns += elapsed_ns(stage_start);  
+ 
+    stage_start = Clock::now();  
+    TopDocuments top_documents(max_count);  
+    for (const Document& document : matched_documents) {  
+        top_documents.Add(document);  
+    }  
+    std::vector<Document> result = top_documents.Extract();  
+    profile.accumulation_ns += elapsed_ns(stage_start);  
+    return result;  
+}  
+ 
+size_t SearchServer::GetDocumentFreq(std::string_view word) const {  
+    const PostingList* document_freqs = FindWordDocumentFreqs(word);  
+    return document_freqs == nullptr ? 0 : document_freqs->size();  
+}  
+ 
+void SearchServer::AddCollectionStatistics(std::string_view raw_query, CollectionStatistics& collection,  
+                                           const std::set<int>& excluded_ids) const {  
+    ScratchScope scratch;  
+    const Query query = ParseSearchQuery(raw_query);  
+    std::pmr::vector<int> excluded_ordinals(GetScratchResource());  
+    for (const int document_id : excluded_ids) {  
+        if (const auto it = documents_.find(document_id); it != documents_.end()) {  
+            excluded_ordinals.push_back(it->second.ordinal);  
+        }  
+    }  
+    collection.document_count += GetDocumentCount() - excluded_ordinals.size();  
+    for (std::string_view word : query.plus_words) {  
+        size_t document_freq = GetDocumentFreq(word);  
+        if (const TermId term_id = terms_.Find(word); term_id != TermDictionary::NO_TERM) {  
+            for (const int ordinal : excluded_ordinals) {  
+                const std::vector<TermId>& document_terms = ordinal_to_terms_[ordinal];  
+                document_freq -= std::binary_search(document_terms.begin(), document_terms.end(), term_id) ? 1 : 0;  
+            }  
+        }  
+        if (const auto it = collection.document_freqs.find(word); it != collection.document_freqs.end()) {  
+            it->second += document_freq;  
+        } else {  
+            collection.document_freqs.emplace(word, document_freq);  
+        }  
+    }  
+}  
+ 
+void SearchServer::MergeFrom(const SearchServer& other, const std::set<int>& excluded_ids) {  
+    for (const auto& [document_id, document_data] : other.documents_) {  
+        if (documents_.count(document_id) != 0 && excluded_ids.count(document_id) == 0) {  
+            throw std::invalid_argument("Некорректный id документа"s);  
+        }  
+    }  
+ 
+    // Документы переносятся в порядке номеров, поэтому в списки терминов они дописываются в конец  
+    std::vector<TermId> term_ids(other.terms_.GetTermCount(), TermDictionary::NO_TERM);  
+    for (size_t other_ordinal = 0; other_ordinal < other.ordinal_to_document_id_.size(); ++other_ordinal) {  
+        const DocumentData* other_data = other.FindDocumentByOrdinal(other_ordinal);  
+        const int document_id = other.ordinal_to_document_id_[other_ordinal];  
+        if (other_data == nullptr || excluded_ids.count(document_id) != 0) {  
+            continue;  
+        }  
+        const int ordinal = static_cast<int>(ordinal_to_document_id_.size());  
+        AppendOrdinal(document_id, other_data->rating, other_data->status);  
+        std::vector<TermId>& document_terms = ordinal_to_terms_[ordinal];  
+        for (const TermId other_term_id : other.ordinal_to_terms_[other_ordinal]) {  
+            if (term_ids[other_term_id] == TermDictionary::NO_TERM) {  
+                term_ids[other_term_id] = terms_.Intern(other.terms_.GetTerm(other_term_id));  
+                term_to_document_freqs_.resize(terms_.GetTermCount(), PostingList(posting_format_));  
+            }  
+            const TermId term_id = term_ids[other_term_id];  
+            term_to_document_freqs_[term_id].Add(ordinal, *other.term_to_document_freqs_[other_term_id].FindTermFreq(other_ordinal));  
+            document_terms.push_back(term_id);  
+        }  
+        std::sort(document_terms.begin(), document_terms.end());  
+        documents_.emplace(document_id, DocumentData{other_data->rating, other_data->status, ordinal, other_data->fingerprint});  
+        documents_id_.insert(document_id);  
+    }  
+    UpdateAllTermStatistics();  
+    index_generation_ = NewIndexGeneration();  
+}  
  
+void SearchServer::SaveSnapshot(const std::string& path) const {  
+    // Номера удалённых документов пропускаем; порядок оставшихся сохраняется, поэтому списки остаются отсортированными  
+    std::vector<int> compact_ordinals(ordinal_to_document_id_.size(), -1);  
+    std::vector<int> document_ids;  
+    std::vector<int> ratings;  
+    std::vector<int> statuses;  
+    std::vector<uint64_t> forward_offsets = {0};  
+    std::vector<TermId> forward_terms;  
+    for (size_t ordinal = 0; ordinal < ordinal_to_document_id_.size(); ++ordinal) {  
+        const DocumentData* document_data = FindDocumentByOrdinal(ordinal);  
+        if (document_data == nullptr) {  
+            continue;  
+        }  
+        const int document_id = ordinal_to_document_id_[ordinal];  
+        compact_ordinals[ordinal] = static_cast<int>(document_ids.size());  
+        document_ids.push_back(document_id);  
+        ratings.push_back(document_data->rating);  
+        statuses.push_back(static_cast<int>(document_data->status));  
+        const std::vector<TermId>& document_terms = ordinal_to_terms_[ordinal];  
+        forward_terms.insert(forward_terms.end(), document_terms.begin(), document_terms.end());  
+        forward_offsets.push_back(forward_terms.size());  
+    }  
+ 
+    std::vector<uint64_t> posting_offsets = {0};  
+    std::vector<double> max_term_freqs;  
+    std::vector<double> term_freqs;  
+    std::vector<int> posting_ordinals;  
+    for (const PostingList& document_freqs : term_to_document_freqs_) {  
+        double max_term_freq = 0;  
+        for (PostingList::Cursor cursor(document_freqs); !cursor.AtEnd(); cursor.Next()) {  
+            posting_ordinals.push_back(compact_ordinals[cursor.GetDocumentId()]);  
+            term_freqs.push_back(cursor.GetTermFreq());  
+            max_term_freq = std::max(max_term_freq, cursor.GetTermFreq());  
+        }  
+        posting_offsets.push_back(posting_ordinals.size());  
+        max_term_freqs.push_back(max_term_freq);  
+    }  
+ 
+    std::vector<std::string_view> terms;  
+    terms.reserve(terms_.GetTermCount());  
+    for (TermId term_id = 0; term_id < terms_.GetTermCount(); ++term_id) {  
+        terms.push_back(terms_.GetTerm(term_id));  
+    }  
  
-bool SearchServer::IsStopWord(const std::string& word) const {  
+    SnapshotWriter writer;  
+    writer.WriteStrings(std::vector<std::string_view>(stop_words_.begin(), stop_words_.end()));  
+    writer.WriteStrings(terms);  
+    writer.WriteArray(posting_offsets);  
+    writer.WriteArray(max_term_freqs);  
+    writer.WriteArray(term_freqs);  
+    writer.WriteArray(posting_ordinals);  
+    writer.WriteArray(document_ids);  
+    writer.WriteArray(ratings);  
+    writer.WriteArray(statuses);  
+    writer.WriteArray(forward_offsets);  
+    writer.WriteArray(forward_terms);  
+ 
+    SnapshotHeader header = {};  
+    header.stop_word_count = stop_words_.size();  
+    header.term_count = terms.size();  
+    header.posting_count = posting_ordinals.size();  
+    header.document_count = document_ids.size();  
+    header.forward_term_count = forward_terms.size();  
+    writer.Save(path, header);  
+}  
+ 
+SearchServer SearchServer::LoadSnapshot(const std::string& path, IndexAllocation allocation) {  
+    auto file = std::make_shared<const MappedFile>(path);  
+    SnapshotReader reader(*file);  
+    const SnapshotHeader& header = reader.GetHeader();  
+ 
+    SearchServer search_server(reader.ReadStrings(header.stop_word_count), allocation);  
+    search_server.snapshot_file_ = file;  
+ 
+    const std::vector<std::string_view> terms = reader.ReadStrings(header.term_count);  
+    for (std::string_view term : terms) {  
+        if (search_server.terms_.InternExternal(term) + 1 != search_server.terms_.GetTermCount()) {  
+            throw std::runtime_error("Слово повторяется в словаре снимка"s);  
+        }  
+    }  
+ 
+    const uint64_t* posting_offsets = reader.ReadArray<uint64_t>(header.term_count + 1);  
+    const double* max_term_freqs = reader.ReadArray<double>(header.term_count);  
+    const double* term_freqs = reader.ReadArray<double>(header.posting_count);  
+    const int* posting_ordinals = reader.ReadArray<int>(header.posting_count);  
+    SnapshotReader::CheckOffsets(posting_offsets, header.term_count, header.posting_count);  
+    if (std::any_of(posting_ordinals, posting_ordinals + header.posting_count, [&header](int ordinal) {  
+            return ordinal < 0 || static_cast<uint64_t>(ordinal) >= header.document_count;  
+        })) {  
+        throw std::runtime_error("Некорректный номер документа в снимке"s);  
+    }  
+    search_server.term_to_document_freqs_.reserve(header.term_count);  
+    for (size_t term_id = 0; term_id < header.term_count; ++term_id) {  
+        const uint64_t begin = posting_offsets[term_id];  
+        const uint64_t end = posting_offsets[term_id + 1];  
+        // Поиск по спискам документов рассчитывает на строго растущие номера без повторов  
+        if (std::adjacent_find(posting_ordinals + begin, posting_ordinals + end, std::greater_equal<int>()) != posting_ordinals + end) {  
+            throw std::runtime_error("Номера документов в списке слова снимка не отсортированы"s);  
+        }  
+        search_server.term_to_document_freqs_.push_back(PostingList::FromExternal(  
+            posting_ordinals + begin, term_freqs + begin, end - begin, max_term_freqs[term_id]));  
+    }  
+ 
+    const int* document_ids = reader.ReadArray<int>(header.document_count);  
+    const int* ratings = reader.ReadArray<int>(header.document_count);  
+    const int* statuses = reader.ReadArray<int>(header.document_count);  
+    const uint64_t* forward_offsets = reader.ReadArray<uint64_t>(header.document_count + 1);  
+    const TermId* forward_terms = reader.ReadArray<TermId>(header.forward_term_count);  
+    SnapshotReader::CheckOffsets(forward_offsets, header.document_count, header.forward_term_count);  
+    if (std::any_of(forward_terms, forward_terms + header.forward_term_count, [&header](TermId term_id) {  
+            return term_id >= header.term_count;  
+        })) {  
+        throw std::runtime_error("Некорректный id слова в снимке"s);  
+    }  
+    for (size_t ordinal = 0; ordinal < header.document_count; ++ordinal) {  
+        const int document_id = document_ids[ordinal];  
+        if (statuses[ordinal] < 0 || statuses[ordinal] >= static_cast<int>(DOCUMENT_STATUS_COUNT)) {  
+            throw std::runtime_error("Некорректный статус документа в снимке"s);  
+        }  
+        std::vector<TermId> document_terms(forward_terms + forward_offsets[ordinal], forward_terms + forward_offsets[ordinal + 1]);  
+        // MatchDocument ищет слова в прямом индексе двоичным поиском  
+        if (std::adjacent_find(document_terms.begin(), document_terms.end(), std::greater_equal<TermId>()) != document_terms.end()) {  
+            throw std::runtime_error("Слова документа в снимке не отсортированы"s);  
+        }  
+        const DocumentData document_data{ratings[ordinal], static_cast<DocumentStatus>(statuses[ordinal]), static_cast<int>(ordinal),  
+                                         search_server.ComputeFingerprint(document_terms)};  
+        if (document_id < 0 || !search_server.documents_.emplace(document_id, document_data).second) {  
+            throw std::runtime_error("Некорректный id документа в снимке"s);  
+        }  
+        search_server.AppendOrdinal(document_id, document_data.rating, document_data.status);  
+        search_server.documents_id_.insert(document_id);  
+        search_server.ordinal_to_terms_[ordinal] = std::move(document_terms);  
+    }  
+    search_server.UpdateAllTermStatistics();  
+    return search_server;  
+}  
+ 
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(std::string_view raw_query, int document_id) const {  
+    const DocumentData& document_data = documents_.at(document_id);  
+    ScratchScope scratch;  
+    const MatchQuery query = ParseMatchQuery(raw_query);  
+    return {MatchDocumentTerms(query, ordinal_to_terms_[document_data.ordinal]), document_data.status};  
+}  
+ 
+std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> SearchServer::MatchDocuments(std::string_view raw_query,  
+                                                                                                     const std::vector<int>& document_ids) const {  
+    return MatchDocuments(std::execution::seq, raw_query, document_ids);  
+}  
+ 
+SearchServer::MatchQuery SearchServer::ParseMatchQuery(std::string_view raw_query) const {  
+    const Query query = ParseQuery(raw_query);  
+    MatchQuery match_query;  
+    match_query.plus_word_count = query.plus_words.size();  
+    // Слова, которых нет в словаре, не встречаются ни в одном документе  
+    for (std::string_view word : query.minus_words) {  
+        const TermId term_id = terms_.Find(word);  
+        if (term_id != TermDictionary::NO_TERM) {  
+            match_query.minus_terms.push_back(term_id);  
+        }  
+    }  
+    for (size_t i = 0; i < query.plus_words.size(); ++i) {  
+        const TermId term_id = terms_.Find(query.plus_words[i]);  
+        if (term_id != TermDictionary::NO_TERM) {  
+            match_query.plus_terms.emplace_back(term_id, i);  
+        }  
+    }  
+    std::sort(match_query.plus_terms.begin(), match_query.plus_terms.end());  
+    return match_query;  
+}  
+ 
+std::vector<std::string_view> SearchServer::MatchDocumentTerms(const MatchQuery& query, const std::vector<TermId>& document_terms) const {  
+    // Хватит одного минус-слова, чтобы документ не подошёл — остальные можно не проверять  
+    for (const TermId term_id : query.minus_terms) {  
+        if (std::binary_search(document_terms.begin(), document_terms.end(), term_id)) {  
+            return {};  
+        }  
+    }  
+ 
+    // Оба списка отсортированы по id, поэтому каждое следующее слово ищется от места предыдущего.  
+    // Найденное слово ставится на своё место в запросе, пустые места потом убираются  
+    std::vector<std::string_view> matched_words(query.plus_word_count);  
+    auto term_it = document_terms.begin();  
+    for (const auto& [term_id, position] : query.plus_terms) {  
+        term_it = std::lower_bound(term_it, document_terms.end(), term_id);  
+        if (term_it == document_terms.end()) {  
+            break;  
+        }  
+        if (*term_it == term_id) {  
+            matched_words[position] = terms_.GetTerm(term_id);  
+        }  
+    }  
+    matched_words.erase(std::remove(matched_words.begin(), matched_words.end(), std::string_view{}), matched_words.end());  
+    return matched_words;  
+}  
+ 
+ 
+bool SearchServer::IsStopWord(std::string_view word) const {  
     return stop_words_.count(word) > 0;  
 }  
  
-bool SearchServer::IsValidWord(const std::string& word) {   
-        return none_of(word.begin(), word.end(), [](char c) {  
+bool SearchServer::IsValidWord(std::string_view word) {   
+        return std::none_of(word.begin(), word.end(), [](char c) {  
             return c >= '\0' && c < ' ';  
         });  
     }
 
-std::vector<std::string> SearchServer::SplitIntoWordsNoStop(const std::string& text) const {  
-    std::vector<std::string> words;  
-    for (const std::string& word : SplitIntoWords(text)) {  
+std::vector<std::string_view> SearchServer::SplitIntoWordsNoStop(std::string_view text) const {  
+    std::vector<std::string_view> words;  
+    for (std::string_view word : SplitIntoWords(text)) {  
         if (!IsValidWord(word)) {  
             throw std::invalid_argument("Некорректное содержание в списке слов документа"s);  
         }  
@@ -119,6 +692,95 @@ std::vector<std::string> SearchServer::SplitIntoWordsNoStop(const std::string& t
     return words;  
 }  
  
+SearchServer::PartialIndex SearchServer::BuildPartialIndex(const std::vector<DocumentRecord>& records, size_t first, size_t last) const {  
+    PartialIndex partial_index;  
+    partial_index.first_record = first;  
+    partial_index.first_new_term = static_cast<TermId>(terms_.GetTermCount());  
+    partial_index.document_ends.reserve(last - first);  
+    // Пока идёт разбор, словарь сервера никто не меняет, поэтому его можно читать из нескольких потоков  
+    std::unordered_map<std::string_view, TermId> new_term_ids;  
+    std::vector<TermId> document_terms;  
+    for (size_t i = first; i < last; ++i) {  
+        const std::vector<std::string_view> words = SplitIntoWordsNoStop(records[i].text);  
+        document_terms.clear();  
+        for (std::string_view word : words) {  
+            TermId term_id = terms_.Find(word);  
+            if (term_id == TermDictionary::NO_TERM) {  
+                const TermId new_term_id = partial_index.first_new_term + static_cast<TermId>(partial_index.new_terms.size());  
+                const auto [it, inserted] = new_term_ids.emplace(word, new_term_id);  
+                if (inserted) {  
+                    partial_index.new_terms.push_back(word);  
+                }  
+                term_id = it->second;  
+            }  
+            document_terms.push_back(term_id);  
+        }  
+ 
+        // Частоты считаются так же, как в AddDocument, чтобы релевантность совпадала до бита  
+        const double inv_word_count = 1.0 / words.size();  
+        DocumentFingerprint fingerprint;  
+        std::sort(document_terms.begin(), document_terms.end());  
+        for (auto term_it = document_terms.begin(); term_it != document_terms.end();) {  
+            const auto term_end = std::upper_bound(term_it, document_terms.end(), *term_it);  
+            partial_index.term_ids.push_back(*term_it);  
+            partial_index.term_freqs.push_back((term_end - term_it) * inv_word_count);  
+            fingerprint.AddTerm(*term_it >= partial_index.first_new_term  
+                                    ? partial_index.new_terms[*term_it - partial_index.first_new_term]  
+                                    : terms_.GetTerm(*term_it));  
+            term_it = term_end;  
+        }  
+        partial_index.document_ends.push_back(partial_index.term_ids.size());  
+        partial_index.fingerprints.push_back(fingerprint);  
+    }  
+    return partial_index;  
+}  
+ 
+void SearchServer::MergePartialIndex(const PartialIndex& partial_index, const std::vector<DocumentRecord>& records, int first_ordinal) {  
+    // Новые слова первой части получают в словаре ровно те id, под которыми записаны.  
+    // В следующих частях они могут сдвинуться или совпасть со словами предыдущих частей  
+    std::vector<TermId> new_term_ids;  
+    new_term_ids.reserve(partial_index.new_terms.size());  
+    bool is_renumbered = false;  
+    for (std::string_view term : partial_index.new_terms) {  
+        new_term_ids.push_back(terms_.Intern(term));  
+        is_renumbered = is_renumbered || new_term_ids.back() != partial_index.first_new_term + new_term_ids.size() - 1;  
+    }  
+    term_to_document_freqs_.resize(terms_.GetTermCount(), PostingList(posting_format_));  
+ 
+    size_t position = 0;  
+    for (size_t i = 0; i < partial_index.document_ends.size(); ++i) {  
+        const size_t record_index = partial_index.first_record + i;  
+        const int ordinal = first_ordinal + static_cast<int>(record_index);  
+        documents_.at(records[record_index].id).fingerprint = partial_index.fingerprints[i];  
+        std::vector<TermId>& document_terms = ordinal_to_terms_[ordinal];  
+        document_terms.reserve(partial_index.document_ends[i] - position);  
+        for (; position < partial_index.document_ends[i]; ++position) {  
+            TermId term_id = partial_index.term_ids[position];  
+            if (term_id >= partial_index.first_new_term) {  
+                term_id = new_term_ids[term_id - partial_index.first_new_term];  
+            }  
+            term_to_document_freqs_[term_id].Add(ordinal, partial_index.term_freqs[position]);  
+            document_terms.push_back(term_id);  
+        }  
+        if (is_renumbered) {  
+            std::sort(document_terms.begin(), document_terms.end());  
+        }  
+    }  
+}  
+ 
+DocumentFingerprint SearchServer::ComputeFingerprint(const std::vector<TermId>& term_ids) const {  
+    DocumentFingerprint fingerprint;  
+    for (const TermId term_id : term_ids) {  
+        fingerprint.AddTerm(terms_.GetTerm(term_id));  
+    }  
+    return fingerprint;  
+}  
+ 
+uint64_t SearchServer::NewIndexGeneration() {  
+    static std::atomic<uint64_t> last_index_generation = 0;  
+    return ++last_index_generation;  
+}  
+ 
 int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {  
     if (ratings.empty()) {  
         return 0;  
@@ -130,15 +792,15 @@ int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
     return rating_sum / static_cast<int>(ratings.size());  
 }  
  
-SearchServer::QueryWord SearchServer::ParseQueryWord(std::string text) const {  
+SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view text) const {  
         if (text.empty()) {  
             throw std::invalid_argument("Поисковой запрос пуст"s);  
         }  
-        std::string word = text;  
+        std::string_view word = text;  
         bool is_minus = false;  
         if (word[0] == '-') {  
             is_minus = true;  
-            word = word.substr(1);  
+            word.remove_prefix(1);  
         }  
         if (word.empty() || word[0] == '-' || !IsValidWord(word)) {  
             throw std::invalid_argument("Некорректное содержание в списке слов документа");  
@@ -147,23 +809,142 @@ SearchServer::QueryWord SearchServer::ParseQueryWord(std::string text) const {
         return {word, is_minus, IsStopWord(word)};  
 }
  
-SearchServer::Query SearchServer::ParseQuery(const std::string& text) const {  
+SearchServer::Query SearchServer::ParseQuery(std::string_view text) const {  
     SearchServer::Query query;  
-    for (const std::string& word : SplitIntoWords(text)) {  
+    query.plus_words.reserve(std::count(text.begin(), text.end(), ' ') + 1);  
+    ForEachWord(text, [this, &query](std::string_view word) {  
         const QueryWord query_word = ParseQueryWord(word);  
         if (!query_word.is_stop) {  
             if (query_word.is_minus) {  
-                query.minus_words.insert(query_word.data);  
+                query.minus_words.push_back(query_word.data);  
             } else {  
-                query.plus_words.insert(query_word.data);  
+                query.plus_words.push_back(query_word.data);  
             }  
         }  
+    });  
+    for (auto* words : {&query.plus_words, &query.minus_words}) {  
+        std::sort(words->begin(), words->end());  
+        words->erase(std::unique(words->begin(), words->end()), words->end());  
+    }  
+    return query;  
+}  
+ 
+ 
+ 
+const PostingList* SearchServer::FindWordDocumentFreqs(std::string_view word) const {  
+    const TermId term_id = terms_.Find(word);  
+    if (term_id == TermDictionary::NO_TERM) {  
+        return nullptr;  
+    }  
+    const PostingList& document_freqs = term_to_document_freqs_[term_id];  
+    return document_freqs.empty() ? nullptr : &document_freqs;  
+}  
+ 
+SearchServer::Query SearchServer::ParseSearchQuery(std::string_view raw_query) const {  
+    INSTRUMENT_STAGE(InstrumentationStage::PARSE);  
+    Query query = ParseQuery(raw_query);  
+    if (!IsValidText(query.plus_words) || !IsValidText(query.minus_words)) {  
+        throw std::invalid_argument("Некорректное содержание в списке слов запроса"s);  
     }  
     return query;  
 }  
  
+double SearchServer::ComputeWordInverseDocumentFreq(const Query& query, std::string_view word, const PostingList& document_freqs) const {  
+    if (query.collection != nullptr) {  
+        // Разность логарифмов, как и для таблиц индекса, чтобы IDF совпадал до бита с IDF одного индекса  
+        return std::log(static_cast<double>(query.collection->document_count))  
+            - std::log(static_cast<double>(query.collection->GetDocumentFreq(word)));  
+    }  
+    // Список лежит в term_to_document_freqs_, поэтому его позиция и есть id термина  
+    return log_document_count_ - term_log_document_freqs_[&document_freqs - term_to_document_freqs_.data()];  
+}  
+ 
+void SearchServer::CollectGarbage() {  
+    // Новые номера выдаются в прежнем порядке, поэтому списки документов и прямой индекс остаются отсортированными  
+    std::vector<int> new_ordinals(ordinal_to_document_id_.size(), -1);  
+    std::vector<int> ordinal_to_document_id;  
+    ordinal_to_document_id.reserve(documents_.size());  
+    std::vector<DocumentMetadata> ordinal_to_metadata;  
+    ordinal_to_metadata.reserve(documents_.size());  
+    std::vector<std::vector<TermId>> ordinal_to_terms;  
+    ordinal_to_terms.reserve(documents_.size());  
+    for (size_t ordinal = 0; ordinal < ordinal_to_document_id_.size(); ++ordinal) {  
+        if (FindDocumentByOrdinal(ordinal) == nullptr) {  
+            continue;  
+        }  
+        const int document_id = ordinal_to_document_id_[ordinal];  
+        new_ordinals[ordinal] = static_cast<int>(ordinal_to_document_id.size());  
+        documents_.at(document_id).ordinal = new_ordinals[ordinal];  
+        ordinal_to_document_id.push_back(document_id);  
+        ordinal_to_metadata.push_back(ordinal_to_metadata_[ordinal]);  
+        ordinal_to_terms.push_back(std::move(ordinal_to_terms_[ordinal]));  
+    }  
+ 
+    TermDictionary terms;  
+    std::vector<PostingList> term_to_document_freqs;  
+    std::vector<TermId> new_term_ids(terms_.GetTermCount(), TermDictionary::NO_TERM);  
+    for (TermId term_id = 0; term_id < terms_.GetTermCount(); ++term_id) {  
+        const PostingList& document_freqs = term_to_document_freqs_[term_id];  
+        if (document_freqs.empty()) {  
+            continue;  
+        }  
+        new_term_ids[term_id] = terms.Intern(terms_.GetTerm(term_id));  
+        PostingList& new_document_freqs = term_to_document_freqs.emplace_back(posting_format_);  
+        for (PostingList::Cursor cursor(document_freqs); !cursor.AtEnd(); cursor.Next()) {  
+            new_document_freqs.Add(new_ordinals[cursor.GetDocumentId()], cursor.GetTermFreq());  
+        }  
+    }  
+    for (std::vector<TermId>& document_terms : ordinal_to_terms) {  
+        for (TermId& term_id : document_terms) {  
+            term_id = new_term_ids[term_id];  
+        }  
+    }  
+ 
+    terms_ = std::move(terms);  
+    term_to_document_freqs_ = std::move(term_to_document_freqs);  
+    ordinal_to_document_id_ = std::move(ordinal_to_document_id);  
+    ordinal_to_metadata_ = std::move(ordinal_to_metadata);  
+    ordinal_to_terms_ = std::move(ordinal_to_terms);  
+    for (size_t status = 0; status < DOCUMENT_STATUS_COUNT; ++status) {  
+        status_bitmaps_[status].Clear();  
+    }  
+    for (size_t ordinal = 0; ordinal < ordinal_to_metadata_.size(); ++ordinal) {  
+        status_bitmaps_[static_cast<size_t>(ordinal_to_metadata_[ordinal].status)].Set(static_cast<int>(ordinal));  
+    }  
+    UpdateAllTermStatistics();  
+    // Слова и списки документов теперь лежат в собственной памяти, снимок больше не нужен  
+    snapshot_file_.reset();  
+}  
+ 
+void SearchServer::AppendOrdinal(int document_id, int rating, DocumentStatus status) {  
+    status_bitmaps_[static_cast<size_t>(status)].Set(static_cast<int>(ordinal_to_document_id_.size()));  
+    ordinal_to_document_id_.push_back(document_id);  
+    ordinal_to_metadata_.push_back({rating, status});  
+    ordinal_to_terms_.emplace_back();  
+}  
  
+void SearchServer::UpdateTermStatistics(TermId term_id) {  
+    const size_t document_freq = term_to_document_freqs_[term_id].size();  
+    term_log_document_freqs_[term_id] = document_freq == 0 ? 0.0 : std::log(static_cast<double>(document_freq));  
+}  
  
-double SearchServer::ComputeWordInverseDocumentFreq(const std::string& word) const {  
-    return std::log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());  
+void SearchServer::UpdateAllTermStatistics() {  
+    term_log_document_freqs_.resize(term_to_document_freqs_.size());  
+    for (TermId term_id = 0; term_id < term_to_document_freqs_.size(); ++term_id) {  
+        UpdateTermStatistics(term_id);  
+    }  
+    UpdateDocumentCountStatistics();  
+}  
+ 
+void SearchServer::UpdateDocumentCountStatistics() {  
+    log_document_count_ = documents_.empty() ? 0.0 : std::log(static_cast<double>(documents_.size()));  
+}  
+ 
+const SearchServer::DocumentData* SearchServer::FindDocumentByOrdinal(size_t ordinal) const {  
+    // id удалённого документа мог быть позже выдан заново, уже с другим номером  
+    const auto document_it = documents_.find(ordinal_to_document_id_[ordinal]);  
+    if (document_it == documents_.end() || document_it->second.ordinal != static_cast<int>(ordinal)) {  
+        return nullptr;  
+    }  
+    return &document_it->second;  
 }  
\ No newline at end of file
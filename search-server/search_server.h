@@ -1,24 +1,123 @@
 #pragma once
  
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 #include <set>
 #include <map>
+#include <memory_resource>
 #include <stdexcept>
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include "document_fingerprint.h"
+#include "index_allocation.h"
+#include "instrumentation.h"
 #include "string_processing.h"
 #include "document.h"
+#include "ordinal_bitmap.h"
+#include "posting_list.h"
+#include "read_input_functions.h"
+#include "relevance_accumulator.h"
+#include "scratch_arena.h"
+#include "snapshot.h"
+#include "top_documents.h"
+#include "term_dictionary.h"
  
 using namespace std::literals;
  
-const int MAX_RESULT_DOCUMENT_COUNT = 5;
+const size_t MAX_RESULT_DOCUMENT_COUNT = 5;
+// Меньшие диапазоны порядковых номеров параллельный поиск не выделяет в отдельные задачи
+const size_t MIN_PARALLEL_ORDINAL_RANGE = 4096;
+const size_t BULK_LOAD_BATCH_SIZE = 10'000;
+// Когда удалённые документы занимают такую долю порядковых номеров, индекс перестраивается без них
+const double MAX_REMOVED_ORDINAL_RATIO = 0.5;
+ 
+// Способ вычисления результата FindTopDocuments. MAX_SCORE даёт тот же результат, что и полный перебор,
+// но списки слов с малым вкладом не обходит целиком, а только проверяет в них документы, которые ещё могут
+// попасть в топ. Выигрыш зависит от запроса, поэтому по умолчанию используется полный перебор
+enum class QueryEvaluation {
+    EXHAUSTIVE,
+    MAX_SCORE,
+};
+ 
+// Фильтры, известные на этапе компиляции. Для них FindTopDocuments выбирает свой цикл подсчёта релевантности
+// без вызова предиката: документы статуса берутся из битовой карты, а рейтинг сравнивается с константой
+template <DocumentStatus Status>
+struct StatusFilter {
+    static constexpr DocumentStatus status = Status;
+};
+ 
+template <int MinRating>
+struct RatingAtLeast {
+    static constexpr int min_rating = MinRating;
+};
+ 
+// Во сколько раз список термина должен быть длиннее множества документов статуса,
+// чтобы перебирать документы статуса и искать их в списке, а не просматривать весь список
+const size_t STATUS_SEEK_RATIO = 8;
+ 
+// Счётчики записей списков плюс-слов, прочитанных и пропущенных при отсечении
+struct PruningStats {
+    size_t postings_visited = 0;
+    size_t postings_skipped = 0;
+};
+ 
+// Время этапов поиска в наносекундах
+struct QueryProfile {
+    uint64_t idf_ns = 0;
+    uint64_t metadata_ns = 0;
+    uint64_t accumulation_ns = 0;
+};
+ 
+// Откуда профилирующий поиск берёт IDF, статус и рейтинг: из таблиц индекса или, как до их появления,
+// считает логарифм для каждого слова запроса и ищет каждый документ в словаре по id
+enum class MetadataSource {
+    TABLES,
+    DOCUMENT_MAP,
+};
+ 
+// Статистика коллекции, разбитой на несколько индексов: IDF слова считается
+// по суммарному числу документов и суммарной документной частоте во всех индексах
+struct CollectionStatistics {
+    size_t document_count = 0;
+    std::map<std::string, size_t, std::less<>> document_freqs;
+ 
+    size_t GetDocumentFreq(std::string_view word) const;
+};
  
 class SearchServer {
 public:
+    using TermId = TermDictionary::TermId;
+ 
+    // Память, занимаемая структурами индекса, в байтах
+    struct IndexMemoryUsage {
+        size_t term_dictionary = 0;
+        size_t inverted_index = 0;
+        size_t forward_index = 0;
+        size_t documents = 0;
+ 
+        size_t Total() const {
+            return term_dictionary + inverted_index + forward_index + documents;
+        }
+    };
+ 
+    // allocation — откуда берут память словари документов (см. IndexAllocation)
     template <typename StringContainer>
-explicit SearchServer(const StringContainer& stop_words)
-    : stop_words_(MakeUniqueNonEmptyStrings(stop_words)) {
+explicit SearchServer(const StringContainer& stop_words, IndexAllocation allocation = IndexAllocation::HEAP)
+    : stop_words_(MakeUniqueNonEmptyStrings(stop_words))
+    , index_resource_(allocation)
+    , documents_(index_resource_.Get())
+    , documents_id_(index_resource_.Get()) {
         for (const auto& stop_word : stop_words) {
             if (!IsValidWord(stop_word)) {
                 throw std::invalid_argument("Некорректное содержание в списке 'стоп-слов'"s);
@@ -27,43 +126,210 @@ explicit SearchServer(const StringContainer& stop_words)
     }
 
  
-    explicit SearchServer(const std::string& stop_words_text);
+    explicit SearchServer(const std::string& stop_words_text, IndexAllocation allocation = IndexAllocation::HEAP);
+ 
+    explicit SearchServer(std::string_view stop_words_text, IndexAllocation allocation = IndexAllocation::HEAP);
  
-    void AddDocument(int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings);
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+ 
+    // Объём данных, загруженных из потока
+    struct BulkLoadStats {
+        size_t document_count = 0;
+        size_t byte_count = 0;
+    };
  
-    std::set<std::string> GetDocumentWordsById(int document_id) const;
+    // Добавляет пакет документов: тексты разбираются параллельно в частичные индексы, которые затем
+    // сливаются в сервер. Если хоть один документ некорректен, исключение выбрасывается до изменения индекса
+    void AddDocuments(const std::vector<DocumentRecord>& records);
  
+    // Читает документы из потока в формате ReadDocuments и добавляет их пакетами по batch_size
+    BulkLoadStats AddDocuments(std::istream& input, size_t batch_size = BULK_LOAD_BATCH_SIZE);
+ 
+    std::set<std::string_view> GetDocumentWordsById(int document_id) const;
+ 
+    // Отсортированные id терминов документа. После удаления документов id терминов могут измениться
+    const std::vector<TermId>& GetDocumentTermIds(int document_id) const;
+ 
+    // Отпечаток набора слов документа: у документов с одинаковым набором слов он совпадает
+    DocumentFingerprint GetDocumentFingerprint(int document_id) const;
+ 
+    // max_count — сколько лучших документов вернуть.
+    // Счётчики stats заполняются только в режиме QueryEvaluation::MAX_SCORE
     template <typename DocumentPredicate>
-    std::vector<Document> FindTopDocuments(const std::string& raw_query, DocumentPredicate document_predicate) const;
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT,
+                                           QueryEvaluation evaluation = QueryEvaluation::EXHAUSTIVE,
+                                           PruningStats* stats = nullptr) const;
+ 
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT,
+                                           QueryEvaluation evaluation = QueryEvaluation::EXHAUSTIVE,
+                                           PruningStats* stats = nullptr) const;
+ 
+    // IDF считается не по этому индексу, а по статистике всей коллекции, частью которой он является
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate, size_t max_count,
+                                           const CollectionStatistics& collection) const;
+ 
+    template <typename ExecutionPolicy, typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentPredicate document_predicate,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+ 
+    // Статус, которого нет ни у одного документа, не требует чтения списков
+    template <DocumentStatus Status>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, StatusFilter<Status> filter,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+ 
+    template <int MinRating>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, RatingAtLeast<MinRating> filter,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+ 
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const;
  
-    std::vector<Document> FindTopDocuments(const std::string& raw_query, DocumentStatus status = DocumentStatus::ACTUAL) const;
+    // Продолжение выдачи после документа after — последнего на предыдущей странице (search-after).
+    // Документы, идущие раньше after, не сортируются и не хранятся, поэтому память не зависит от глубины страницы
+    std::vector<Document> FindTopDocumentsAfter(std::string_view raw_query, DocumentStatus status, const Document& after,
+                                                size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+ 
+    // Страница page_index (с нуля) по page_size документов, когда конец предыдущей страницы неизвестен.
+    // Отбираются (page_index + 1) * page_size лучших, но по порядку выстраивается только сама страница
+    std::vector<Document> FindTopDocumentsPage(std::string_view raw_query, DocumentStatus status, size_t page_index,
+                                               size_t page_size) const;
  
     int GetDocumentId(int index);
  
-    std::set<int>::const_iterator begin();
+    std::pmr::set<int>::const_iterator begin() const;
  
-    std::set<int>::const_iterator end();
+    std::pmr::set<int>::const_iterator end() const;
  
     int GetDocumentCount() const;
  
-    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& raw_query, int document_id) const;
+    bool HasDocument(int document_id) const;
+ 
+    const std::set<std::string, std::less<>>& GetStopWords() const;
+ 
+    // Меняется при каждом добавлении и удалении документов. Копия индекса получает то же значение,
+    // а независимо построенные индексы — разные, поэтому по нему можно проверять, устарел ли результат поиска
+    uint64_t GetIndexGeneration() const;
+ 
+    // Запрос в каноническом виде: плюс-слова и минус-слова по алфавиту, без повторов и стоп-слов.
+    // Запросы с одинаковым каноническим видом дают одинаковый результат. Некорректный запрос вызывает исключение
+    std::string NormalizeQuery(std::string_view raw_query) const;
+ 
+    // Слова запроса ищутся в отсортированном списке терминов документа, а не в списках документов терминов.
+    // string_view ссылаются на словарь сервера
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+ 
+    // Пересечение с терминами одного документа быстрее, чем раздача слов запроса потокам, поэтому policy не используется
+    template <typename ExecutionPolicy>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(ExecutionPolicy&& policy, std::string_view raw_query, int document_id) const;
+ 
+    // MatchDocument для каждого документа из document_ids: запрос разбирается и ищется в словаре один раз.
+    // Отсутствующий id вызывает исключение до начала сопоставления
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> MatchDocuments(std::string_view raw_query,
+                                                                                           const std::vector<int>& document_ids) const;
+ 
+    // Документы сопоставляются параллельно
+    template <typename ExecutionPolicy>
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> MatchDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+                                                                                           const std::vector<int>& document_ids) const;
+ 
+    // Отсутствующий id ничего не меняет
+    void RemoveDocument(int document_id);
+ 
+    // Удаляет документы пакетом: список документов каждого затронутого термина перестраивается
+    // один раз, а время не зависит от размера остальных списков. Отсутствующие id пропускаются
+    void RemoveDocuments(const std::vector<int>& document_ids);
+ 
+    // Списки разных терминов перестраиваются параллельно
+    template <typename ExecutionPolicy>
+    void RemoveDocuments(ExecutionPolicy&& policy, const std::vector<int>& document_ids);
  
-     void RemoveDocument(int document_id);
+    IndexMemoryUsage GetMemoryUsage() const;
+ 
+    // Перестраивает списки документов всех терминов в формате format; новые списки создаются в нём же.
+    // Результаты поиска от формата не зависят
+    void SetPostingFormat(PostingFormat format);
+ 
+    PostingFormat GetPostingFormat() const;
+ 
+    // Поиск по статусу, разбитый на этапы, время которых добавляется к profile: IDF слов запроса,
+    // чтение статуса и рейтинга документов, накопление релевантности с отбором лучших.
+    // Результат совпадает с FindTopDocuments
+    std::vector<Document> ProfileFindTopDocuments(std::string_view raw_query, DocumentStatus status, QueryProfile& profile,
+                                                  MetadataSource source = MetadataSource::TABLES,
+                                                  size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+ 
+    // Число документов, содержащих слово
+    size_t GetDocumentFreq(std::string_view word) const;
+ 
+    // Добавляет к collection число документов этого индекса и частоты слов запроса в нём.
+    // Документы excluded_ids не учитываются, как будто их уже удалили
+    void AddCollectionStatistics(std::string_view raw_query, CollectionStatistics& collection,
+                                 const std::set<int>& excluded_ids = {}) const;
+ 
+    // Переносит в этот индекс документы other, кроме excluded_ids, без повторного разбора текста.
+    // Стоп-слова обоих индексов должны совпадать; при повторе id индекс не меняется
+    void MergeFrom(const SearchServer& other, const std::set<int>& excluded_ids = {});
+ 
+    // Записывает индекс в двоичный снимок. Порядковые номера документов при этом уплотняются
+    void SaveSnapshot(const std::string& path) const;
+ 
+    // Загружает снимок через отображение файла в память: списки документов терминов и текст слов
+    // читаются прямо из файла и копируются только при изменении, остальные структуры строятся заново.
+    // Словари документов по умолчанию берут память из кучи. MONOTONIC подходит только снимку, который
+    // дальше читается без изменений: память удалённых им документов не освобождается до уничтожения индекса
+    static SearchServer LoadSnapshot(const std::string& path, IndexAllocation allocation = IndexAllocation::HEAP);
+ 
+    IndexAllocation GetIndexAllocation() const;
  
 private:
     struct DocumentData {
         int rating;
         DocumentStatus status;
+        int ordinal;
+        // Отпечаток набора слов, считается при добавлении документа
+        DocumentFingerprint fingerprint;
     };
-    const std::set<std::string> stop_words_;
-    std::map<std::string, std::map<int, double>> word_to_document_freqs_;
-    std::map<int, DocumentData> documents_;
-    std::map<int, std::set<std::string>> words_to_documents_;
-    std::set<int> documents_id_;
- 
-    bool IsStopWord(const std::string& word) const;
- 
-    static bool IsValidWord(const std::string& word);
+    // Единственное хранилище текста слов; индексы ссылаются на слова по id
+    TermDictionary terms_;
+    const std::set<std::string, std::less<>> stop_words_;
+    // Обратный индекс: i-й элемент — документы, содержащие термин с id i, и частота термина в них
+    std::vector<PostingList> term_to_document_freqs_;
+    PostingFormat posting_format_ = PostingFormat::PLAIN;
+    // Объявлен до словарей документов, которые берут из него память, и разрушается после них
+    IndexMemoryResource index_resource_;
+    std::pmr::map<int, DocumentData> documents_;
+    // Порядковые номера документов выдаются подряд при добавлении и не переиспользуются.
+    // Списки документов терминов хранят номера, а не id, чтобы релевантность копилась в плоском массиве
+    std::vector<int> ordinal_to_document_id_;
+    // Статус и рейтинг по порядковому номеру: при обходе списков их не нужно искать в documents_
+    struct DocumentMetadata {
+        int rating;
+        DocumentStatus status;
+    };
+    std::vector<DocumentMetadata> ordinal_to_metadata_;
+    // Номера неудалённых документов каждого статуса
+    std::array<OrdinalBitmap, DOCUMENT_STATUS_COUNT> status_bitmaps_;
+    // IDF термина равен log_document_count_ - term_log_document_freqs_[id]. Логарифмы пересчитываются
+    // только для терминов, чьи списки документов изменились, а не для каждого слова каждого запроса
+    std::vector<double> term_log_document_freqs_;
+    double log_document_count_ = 0.0;
+    // Прямой индекс: отсортированные id терминов документа по его порядковому номеру. У удалённых документов список пуст
+    std::vector<std::vector<TermId>> ordinal_to_terms_;
+    std::pmr::set<int> documents_id_;
+    // Файл снимка, на который ссылаются terms_ и term_to_document_freqs_ после LoadSnapshot
+    std::shared_ptr<const MappedFile> snapshot_file_;
+    uint64_t index_generation_ = NewIndexGeneration();
+ 
+    // Номера поколений выдаются из общего счётчика всех индексов
+    static uint64_t NewIndexGeneration();
+ 
+    bool IsStopWord(std::string_view word) const;
+ 
+    static bool IsValidWord(std::string_view word);
     
    template <typename Container>
 static bool IsValidText(const Container& text) {
@@ -76,87 +342,578 @@ static bool IsValidText(const Container& text) {
 }
  
  
-    std::vector<std::string> SplitIntoWordsNoStop(const std::string& text) const;
+    std::vector<std::string_view> SplitIntoWordsNoStop(std::string_view text) const;
+ 
+    // Индекс части пакета документов. Слова, которых ещё нет в словаре сервера,
+    // нумеруются с first_new_term в порядке появления и добавляются в словарь при слиянии
+    struct PartialIndex {
+        size_t first_record = 0;
+        TermId first_new_term = 0;
+        std::vector<std::string_view> new_terms;
+        // Термины всех документов подряд: id и частота в документе.
+        // Термины i-го документа отсортированы и заканчиваются на позиции document_ends[i]
+        std::vector<TermId> term_ids;
+        std::vector<double> term_freqs;
+        std::vector<size_t> document_ends;
+        std::vector<DocumentFingerprint> fingerprints;
+    };
+ 
+    PartialIndex BuildPartialIndex(const std::vector<DocumentRecord>& records, size_t first, size_t last) const;
+ 
+    void MergePartialIndex(const PartialIndex& partial_index, const std::vector<DocumentRecord>& records, int first_ordinal);
  
+    DocumentFingerprint ComputeFingerprint(const std::vector<TermId>& term_ids) const;
+
     static int ComputeAverageRating(const std::vector<int>& ratings);
  
     struct QueryWord {
-        std::string data;
+        std::string_view data;
         bool is_minus;
         bool is_stop;
     };
  
-    QueryWord ParseQueryWord(std::string text) const;
+    QueryWord ParseQueryWord(std::string_view text) const;
  
+    // Слова запроса отсортированы и не повторяются.
+    // Если задана collection, IDF считается по ней, а не по этому индексу.
+    // Списки слов лежат во временной памяти запроса (ScratchScope)
     struct Query {
-        std::set<std::string> plus_words;
-        std::set<std::string> minus_words;
+        std::pmr::vector<std::string_view> plus_words{GetScratchResource()};
+        std::pmr::vector<std::string_view> minus_words{GetScratchResource()};
+        const CollectionStatistics* collection = nullptr;
+    };
+ 
+    Query ParseQuery(std::string_view text) const;
+ 
+    // Разбирает запрос и проверяет, что в нём нет недопустимых слов
+    Query ParseSearchQuery(std::string_view raw_query) const;
+ 
+    // Запрос для MatchDocument: id слов, которые есть в словаре. Плюс-слова отсортированы по id
+    // и помнят своё место среди плюс-слов запроса, чтобы найденные слова шли в порядке запроса
+    struct MatchQuery {
+        std::pmr::vector<TermId> minus_terms{GetScratchResource()};
+        std::pmr::vector<std::pair<TermId, size_t>> plus_terms{GetScratchResource()};
+        size_t plus_word_count = 0;
     };
  
-    Query ParseQuery(const std::string& text) const;
+    MatchQuery ParseMatchQuery(std::string_view raw_query) const;
  
-    // Existence required
-    double ComputeWordInverseDocumentFreq(const std::string& word) const;
+    // Пересекает запрос с отсортированными id терминов документа
+    std::vector<std::string_view> MatchDocumentTerms(const MatchQuery& query, const std::vector<TermId>& document_terms) const;
  
+    // Возвращает nullptr, если слова нет ни в одном документе, в том числе после удаления всех его документов
+    const PostingList* FindWordDocumentFreqs(std::string_view word) const;
+ 
+    double ComputeWordInverseDocumentFreq(const Query& query, std::string_view word, const PostingList& document_freqs) const;
+ 
+    // Возвращает nullptr, если номер принадлежит удалённому документу
+    const DocumentData* FindDocumentByOrdinal(size_t ordinal) const;
+ 
+    // Перенумеровывает документы и термины подряд, выбрасывая удалённые документы и термины без документов
+    void CollectGarbage();
+ 
+    // Выдаёт документу следующий порядковый номер
+    void AppendOrdinal(int document_id, int rating, DocumentStatus status);
+ 
+    // Обновляют логарифмы числа документов: для одного термина, для всех терминов и для всего индекса
+    void UpdateTermStatistics(TermId term_id);
+ 
+    void UpdateAllTermStatistics();
+ 
+    void UpdateDocumentCountStatistics();
+ 
+    // Передаёт каждый найденный документ в top_documents сразу после подсчёта релевантности
+    template <typename DocumentPredicate>
+    void FindAllDocuments(std::execution::sequenced_policy, const Query& query, DocumentPredicate document_predicate,
+                          TopDocuments& top_documents) const;
+ 
+    template <typename DocumentPredicate>
+    void FindAllDocuments(std::execution::parallel_policy, const Query& query, DocumentPredicate document_predicate,
+                          TopDocuments& top_documents) const;
+ 
+    // Обход списков плюс-слов с фильтром, известным на этапе компиляции
+    // Полный перебор с фильтром по статусу, результат — в top_documents
+    void CollectTopDocuments(std::string_view raw_query, DocumentStatus status, TopDocuments& top_documents) const;
+ 
+    template <typename Filter>
+    void FindAllDocumentsFiltered(const Query& query, Filter filter, TopDocuments& top_documents) const;
+ 
+    template <DocumentStatus Status>
+    void AccumulateImpacts(const PostingList& document_freqs, double inverse_document_freq, StatusFilter<Status> filter,
+                           RelevanceAccumulator& document_to_relevance) const;
+ 
+    template <int MinRating>
+    void AccumulateImpacts(const PostingList& document_freqs, double inverse_document_freq, RatingAtLeast<MinRating> filter,
+                           RelevanceAccumulator& document_to_relevance) const;
+ 
+    // Обход документ за документом с отсечением по алгоритму MaxScore
     template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const Query& query, DocumentPredicate document_predicate) const;
+    void FindAllDocumentsMaxScore(const Query& query, DocumentPredicate document_predicate,
+                                  TopDocuments& top_documents, PruningStats& stats) const;
 };
  
 // Вне класса SearchServer:
 template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& raw_query, DocumentPredicate document_predicate) const {
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+                                                     size_t max_count, QueryEvaluation evaluation,
+                                                     PruningStats* stats) const {
+    if (evaluation == QueryEvaluation::EXHAUSTIVE) {
+        return FindTopDocuments(std::execution::seq, raw_query, document_predicate, max_count);
+    }
+ 
+    ScratchScope scratch;
+    const Query query = ParseSearchQuery(raw_query);
+    TopDocuments top_documents(max_count);
+    PruningStats local_stats;
+    FindAllDocumentsMaxScore(query, document_predicate, top_documents, stats != nullptr ? *stats : local_stats);
+    return top_documents.Extract();
+}
+ 
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate, size_t max_count,
+                                                     const CollectionStatistics& collection) const {
+    ScratchScope scratch;
+    Query query = ParseSearchQuery(raw_query);
+    query.collection = &collection;
+    TopDocuments top_documents(max_count);
+    FindAllDocuments(std::execution::seq, query, document_predicate, top_documents);
+    return top_documents.Extract();
+}
  
-    std::vector<Document> documents;
-    const Query query = ParseQuery(raw_query);
-    if (!IsValidText(query.plus_words) || !IsValidText(query.minus_words)) {
-        throw std::invalid_argument("Некорректное содержание в списке слов запроса"s);
+template <typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status,
+                                                     size_t max_count) const {
+    return FindTopDocuments(
+        policy, raw_query, [status]([[maybe_unused]] int document_id, DocumentStatus document_status, [[maybe_unused]] int rating) {
+            return document_status == status;
+        }, max_count);
+}
+ 
+template <typename ExecutionPolicy, typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentPredicate document_predicate,
+                                                     size_t max_count) const {
+    ScratchScope scratch;
+    const Query query = ParseSearchQuery(raw_query);
+ 
+    // Полная сортировка всех найденных документов не нужна: храним только max_count лучших
+    TopDocuments top_documents(max_count);
+    FindAllDocuments(policy, query, document_predicate, top_documents);
+    return top_documents.Extract();
+}
+ 
+template <DocumentStatus Status>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, StatusFilter<Status> filter, size_t max_count) const {
+    ScratchScope scratch;
+    const Query query = ParseSearchQuery(raw_query);
+    TopDocuments top_documents(max_count);
+    if (status_bitmaps_[static_cast<size_t>(Status)].Count() != 0) {
+        FindAllDocumentsFiltered(query, filter, top_documents);
+    }
+    return top_documents.Extract();
+}
+ 
+template <int MinRating>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, RatingAtLeast<MinRating> filter, size_t max_count) const {
+    ScratchScope scratch;
+    const Query query = ParseSearchQuery(raw_query);
+    TopDocuments top_documents(max_count);
+    FindAllDocumentsFiltered(query, filter, top_documents);
+    return top_documents.Extract();
+}
+ 
+template <typename ExecutionPolicy>
+void SearchServer::RemoveDocuments(ExecutionPolicy&& policy, const std::vector<int>& document_ids) {
+    // Пары (термин, номер документа) всех удаляемых документов; после сортировки номера одного термина идут подряд
+    std::vector<std::pair<TermId, int>> term_ordinals;
+    bool is_changed = false;
+    for (const int document_id : document_ids) {
+        const auto document_it = documents_.find(document_id);
+        if (document_it == documents_.end()) {
+            continue;
+        }
+        std::vector<TermId>& document_terms = ordinal_to_terms_[document_it->second.ordinal];
+        for (const TermId term_id : document_terms) {
+            term_ordinals.emplace_back(term_id, document_it->second.ordinal);
+        }
+        // Номер удалённого документа не переиспользуется, поэтому память списка освобождается сразу
+        std::vector<TermId>().swap(document_terms);
+        status_bitmaps_[static_cast<size_t>(document_it->second.status)].Reset(document_it->second.ordinal);
+        documents_id_.erase(document_id);
+        documents_.erase(document_it);
+        is_changed = true;
+    }
+    if (is_changed) {
+        index_generation_ = NewIndexGeneration();
+    }
+    std::sort(policy, term_ordinals.begin(), term_ordinals.end());
+ 
+    std::vector<int> ordinals(term_ordinals.size());
+    std::vector<std::pair<size_t, size_t>> term_ranges;
+    for (size_t i = 0; i < term_ordinals.size(); ++i) {
+        ordinals[i] = term_ordinals[i].second;
+        if (i == 0 || term_ordinals[i].first != term_ordinals[i - 1].first) {
+            term_ranges.emplace_back(i, i);
+        }
+        term_ranges.back().second = i + 1;
+    }
+    // Каждый поток меняет только списки своих терминов
+    std::for_each(policy, term_ranges.begin(), term_ranges.end(), [&](const std::pair<size_t, size_t>& range) {
+        const TermId term_id = term_ordinals[range.first].first;
+        term_to_document_freqs_[term_id].RemoveSorted(ordinals.data() + range.first, ordinals.data() + range.second);
+        UpdateTermStatistics(term_id);
+    });
+    UpdateDocumentCountStatistics();
+ 
+    const size_t removed_ordinal_count = ordinal_to_document_id_.size() - documents_.size();
+    if (removed_ordinal_count > 0 && removed_ordinal_count >= MAX_REMOVED_ORDINAL_RATIO * ordinal_to_document_id_.size()) {
+        CollectGarbage();
     }
-    documents = FindAllDocuments(query, document_predicate);
+}
+ 
+template <typename ExecutionPolicy>
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument([[maybe_unused]] ExecutionPolicy&& policy,
+                                                                                     std::string_view raw_query, int document_id) const {
+    return MatchDocument(raw_query, document_id);
+}
  
-    sort(documents.begin(), documents.end(),
-         [](const Document& lhs, const Document& rhs) {
-            double ALLOWABLE_ERROR = 1e-6;
-             if (std::abs(lhs.relevance - rhs.relevance) < ALLOWABLE_ERROR) {
-                 return lhs.rating > rhs.rating;
-             } else {
-                 return lhs.relevance > rhs.relevance;
-             }
-         });
-    if (documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+template <typename ExecutionPolicy>
+std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> SearchServer::MatchDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+                                                                                                     const std::vector<int>& document_ids) const {
+    ScratchScope scratch;
+    // Документы ищутся до параллельной части: исключение из неё завершило бы программу
+    std::pmr::vector<const DocumentData*> documents(GetScratchResource());
+    documents.reserve(document_ids.size());
+    for (const int document_id : document_ids) {
+        documents.push_back(&documents_.at(document_id));
     }
-    return documents;
+    const MatchQuery query = ParseMatchQuery(raw_query);
+ 
+    std::vector<std::tuple<std::vector<std::string_view>, DocumentStatus>> results(documents.size());
+    std::transform(policy, documents.begin(), documents.end(), results.begin(),
+                   [this, &query](const DocumentData* document_data) {
+                       return std::tuple{MatchDocumentTerms(query, ordinal_to_terms_[document_data->ordinal]), document_data->status};
+                   });
+    return results;
 }
  
 template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const Query& query, DocumentPredicate document_predicate) const {
-    std::map<int, double> document_to_relevance;
-    for (const std::string& word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
+void SearchServer::FindAllDocuments(std::execution::sequenced_policy, const Query& query, DocumentPredicate document_predicate,
+                                    TopDocuments& top_documents) const {
+    std::pmr::vector<std::pair<std::string_view, const PostingList*>> plus_document_freqs(GetScratchResource());
+    plus_document_freqs.reserve(query.plus_words.size());
+    size_t expected_document_count = 0;
+    for (std::string_view word : query.plus_words) {
+        if (const auto* document_freqs = FindWordDocumentFreqs(word)) {
+            plus_document_freqs.emplace_back(word, document_freqs);
+            expected_document_count += document_freqs->size();
+        }
+    }
+ 
+    // Режим аккумулятора выбирается по суммарной длине списков плюс-слов
+    ScopedRelevanceAccumulator document_to_relevance;
+    document_to_relevance->Reset(ordinal_to_document_id_.size(), expected_document_count);
+    {
+        INSTRUMENT_STAGE(InstrumentationStage::POSTING_SCAN);
+        for (const auto& [word, document_freqs] : plus_document_freqs) {
+            const double inverse_document_freq = ComputeWordInverseDocumentFreq(query, word, *document_freqs);
+            document_freqs->ForEachImpact(inverse_document_freq, [&](int ordinal, double impact) {
+                const DocumentMetadata& metadata = ordinal_to_metadata_[ordinal];
+                if (document_predicate(ordinal_to_document_id_[ordinal], metadata.status, metadata.rating)) {
+                    document_to_relevance->Add(ordinal, impact);
+                }
+            });
+        }
+    }
+ 
+    {
+        INSTRUMENT_STAGE(InstrumentationStage::MINUS_FILTER);
+        for (std::string_view word : query.minus_words) {
+            if (const auto* document_freqs = FindWordDocumentFreqs(word)) {
+                document_freqs->ForEach([&document_to_relevance](int ordinal, [[maybe_unused]] double term_freq) {
+                    document_to_relevance->Exclude(ordinal);
+                });
+            }
+        }
+    }
+ 
+    INSTRUMENT_STAGE(InstrumentationStage::ACCUMULATE);
+    document_to_relevance->ForEach([this, &top_documents](int ordinal, double relevance) {
+        top_documents.Add({ordinal_to_document_id_[ordinal], relevance, ordinal_to_metadata_[ordinal].rating});
+    });
+}
+ 
+template <typename DocumentPredicate>
+void SearchServer::FindAllDocuments(std::execution::parallel_policy, const Query& query, DocumentPredicate document_predicate,
+                                    TopDocuments& top_documents) const {
+    // Порядковые номера делятся на непересекающиеся диапазоны, и каждый диапазон считается в своём потоке
+    // собственным аккумулятором. Релевантность документа складывается в порядке слов запроса, как в
+    // последовательной версии, а диапазоны сливаются по порядку, поэтому результат от запуска к запуску не меняется
+    std::vector<std::pair<const PostingList*, double>> plus_document_freqs;
+    plus_document_freqs.reserve(query.plus_words.size());
+    size_t expected_document_count = 0;
+    for (std::string_view word : query.plus_words) {
+        if (const auto* document_freqs = FindWordDocumentFreqs(word)) {
+            plus_document_freqs.emplace_back(document_freqs, ComputeWordInverseDocumentFreq(query, word, *document_freqs));
+            expected_document_count += document_freqs->size();
+        }
+    }
+    std::vector<const PostingList*> minus_document_freqs;
+    for (std::string_view word : query.minus_words) {
+        if (const auto* document_freqs = FindWordDocumentFreqs(word)) {
+            minus_document_freqs.push_back(document_freqs);
+        }
+    }
+ 
+    const size_t ordinal_count = ordinal_to_document_id_.size();
+    const size_t max_range_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const size_t range_count = std::clamp<size_t>(ordinal_count / MIN_PARALLEL_ORDINAL_RANGE, 1, max_range_count);
+    std::vector<std::vector<std::pair<int, double>>> range_relevances(range_count);
+    {
+        INSTRUMENT_STAGE(InstrumentationStage::POSTING_SCAN);
+        std::vector<size_t> range_indexes(range_count);
+        std::iota(range_indexes.begin(), range_indexes.end(), 0);
+        std::for_each(std::execution::par, range_indexes.begin(), range_indexes.end(), [&](size_t range_index) {
+            const int first_ordinal = static_cast<int>(ordinal_count * range_index / range_count);
+            const int last_ordinal = static_cast<int>(ordinal_count * (range_index + 1) / range_count);
+            ScopedRelevanceAccumulator document_to_relevance;
+            // Документы запроса могут оказаться в одном диапазоне, поэтому оценка — по всему запросу:
+            // в режиме хеш-таблицы меньшая оценка переполнила бы таблицу
+            document_to_relevance->Reset(ordinal_count, expected_document_count);
+            for (const auto& [document_freqs, inverse_document_freq] : plus_document_freqs) {
+                document_freqs->ForEachImpactInRange(inverse_document_freq, first_ordinal, last_ordinal, [&](int ordinal, double impact) {
+                    const DocumentMetadata& metadata = ordinal_to_metadata_[ordinal];
+                    if (document_predicate(ordinal_to_document_id_[ordinal], metadata.status, metadata.rating)) {
+                        document_to_relevance->Add(ordinal, impact);
+                    }
+                });
+            }
+            for (const PostingList* document_freqs : minus_document_freqs) {
+                document_freqs->ForEachImpactInRange(0.0, first_ordinal, last_ordinal,
+                    [&document_to_relevance](int ordinal, [[maybe_unused]] double impact) {
+                        document_to_relevance->Exclude(ordinal);
+                    });
+            }
+            document_to_relevance->ForEach([&relevances = range_relevances[range_index]](int ordinal, double relevance) {
+                relevances.emplace_back(ordinal, relevance);
+            });
+        });
+    }
+ 
+    INSTRUMENT_STAGE(InstrumentationStage::ACCUMULATE);
+    for (const auto& relevances : range_relevances) {
+        for (const auto& [ordinal, relevance] : relevances) {
+            top_documents.Add({ordinal_to_document_id_[ordinal], relevance, ordinal_to_metadata_[ordinal].rating});
+        }
+    }
+}
+ 
+template <typename Filter>
+void SearchServer::FindAllDocumentsFiltered(const Query& query, Filter filter, TopDocuments& top_documents) const {
+    std::pmr::vector<std::pair<std::string_view, const PostingList*>> plus_document_freqs(GetScratchResource());
+    plus_document_freqs.reserve(query.plus_words.size());
+    size_t expected_document_count = 0;
+    for (std::string_view word : query.plus_words) {
+        if (const auto* document_freqs = FindWordDocumentFreqs(word)) {
+            plus_document_freqs.emplace_back(word, document_freqs);
+            expected_document_count += document_freqs->size();
+        }
+    }
+ 
+    ScopedRelevanceAccumulator document_to_relevance;
+    document_to_relevance->Reset(ordinal_to_document_id_.size(), expected_document_count);
+    {
+        INSTRUMENT_STAGE(InstrumentationStage::POSTING_SCAN);
+        for (const auto& [word, document_freqs] : plus_document_freqs) {
+            AccumulateImpacts(*document_freqs, ComputeWordInverseDocumentFreq(query, word, *document_freqs), filter, *document_to_relevance);
         }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-            const auto& document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                document_to_relevance[document_id] += term_freq * inverse_document_freq;
+    }
+ 
+    {
+        INSTRUMENT_STAGE(InstrumentationStage::MINUS_FILTER);
+        for (std::string_view word : query.minus_words) {
+            if (const auto* document_freqs = FindWordDocumentFreqs(word)) {
+                document_freqs->ForEach([&document_to_relevance](int ordinal, [[maybe_unused]] double term_freq) {
+                    document_to_relevance->Exclude(ordinal);
+                });
             }
         }
     }
  
-    for (const std::string& word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
+    INSTRUMENT_STAGE(InstrumentationStage::ACCUMULATE);
+    document_to_relevance->ForEach([this, &top_documents](int ordinal, double relevance) {
+        top_documents.Add({ordinal_to_document_id_[ordinal], relevance, ordinal_to_metadata_[ordinal].rating});
+    });
+}
+ 
+template <DocumentStatus Status>
+void SearchServer::AccumulateImpacts(const PostingList& document_freqs, double inverse_document_freq, [[maybe_unused]] StatusFilter<Status> filter,
+                                     RelevanceAccumulator& document_to_relevance) const {
+    const OrdinalBitmap& status_bitmap = status_bitmaps_[static_cast<size_t>(Status)];
+    if (status_bitmap.Count() * STATUS_SEEK_RATIO >= document_freqs.size()) {
+        document_freqs.ForEachImpact(inverse_document_freq, [&](int ordinal, double impact) {
+            if (status_bitmap.Test(ordinal)) {
+                document_to_relevance.Add(ordinal, impact);
+            }
+        });
+        return;
+    }
+    // Документов статуса намного меньше, чем записей в списке: записи остальных статусов перескакиваются галопом
+    PostingList::Cursor cursor(document_freqs);
+    status_bitmap.ForEach([&](int ordinal) {
+        cursor.SeekTo(ordinal);
+        if (cursor.AtEnd()) {
+            return false;
+        }
+        if (cursor.GetDocumentId() == ordinal) {
+            document_to_relevance.Add(ordinal, cursor.GetTermFreq() * inverse_document_freq);
+        }
+        return true;
+    });
+}
+ 
+template <int MinRating>
+void SearchServer::AccumulateImpacts(const PostingList& document_freqs, double inverse_document_freq, [[maybe_unused]] RatingAtLeast<MinRating> filter,
+                                     RelevanceAccumulator& document_to_relevance) const {
+    document_freqs.ForEachImpact(inverse_document_freq, [&](int ordinal, double impact) {
+        if (ordinal_to_metadata_[ordinal].rating >= MinRating) {
+            document_to_relevance.Add(ordinal, impact);
+        }
+    });
+}
+ 
+template <typename DocumentPredicate>
+void SearchServer::FindAllDocumentsMaxScore(const Query& query, DocumentPredicate document_predicate,
+                                            TopDocuments& top_documents, PruningStats& stats) const {
+    INSTRUMENT_STAGE(InstrumentationStage::POSTING_SCAN);
+    struct QueryTerm {
+        const PostingList* document_freqs;
+        double inverse_document_freq;
+        double max_impact;
+    };
+ 
+    // Термины идут в порядке слов запроса: в этом же порядке складывается окончательная релевантность,
+    // поэтому результат совпадает с полным перебором до последнего бита
+    std::pmr::vector<QueryTerm> terms(GetScratchResource());
+    terms.reserve(query.plus_words.size());
+    size_t total_postings = 0;
+    for (std::string_view word : query.plus_words) {
+        const auto* document_freqs = FindWordDocumentFreqs(word);
+        if (document_freqs == nullptr || document_freqs->empty()) {
             continue;
         }
-        for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
+        const double inverse_document_freq = ComputeWordInverseDocumentFreq(query, word, *document_freqs);
+        terms.push_back({document_freqs, inverse_document_freq, document_freqs->GetMaxTermFreq() * inverse_document_freq});
+        total_postings += document_freqs->size();
+    }
+ 
+    // Документы с минус-словами отмечаются заранее: они не должны поднимать порог
+    OrdinalBitmap excluded;
+    for (std::string_view word : query.minus_words) {
+        if (const auto* document_freqs = FindWordDocumentFreqs(word)) {
+            document_freqs->ForEach([&excluded](int ordinal, [[maybe_unused]] double term_freq) {
+                excluded.Set(ordinal);
+            });
+        }
+    }
+    const bool has_excluded = excluded.Count() != 0;
+ 
+    // by_impact — термины по убыванию максимального вклада; remaining_bound[j] — сумма вкладов терминов by_impact[j..].
+    // Списки обходятся целиком в этом порядке, пока документ, которого ещё нет в аккумуляторе, может пройти порог.
+    // Остальные списки только проверяются для документов, которые с ними ещё могут его пройти
+    std::pmr::vector<size_t> by_impact(terms.size(), GetScratchResource());
+    std::iota(by_impact.begin(), by_impact.end(), 0);
+    std::sort(by_impact.begin(), by_impact.end(), [&terms](size_t lhs, size_t rhs) {
+        return terms[lhs].max_impact > terms[rhs].max_impact;
+    });
+    std::pmr::vector<double> remaining_bound(terms.size() + 1, 0.0, GetScratchResource());
+    for (size_t j = terms.size(); j > 0; --j) {
+        remaining_bound[j - 1] = remaining_bound[j] + terms[by_impact[j - 1]].max_impact;
+    }
+ 
+    // Порог — k-я по величине накопленная релевантность: окончательная релевантность не меньше накопленной,
+    // поэтому документ, который не выше порога, не лучше худшего из k лучших.
+    // Запас в два допуска компаратора покрывает разницу в округлении при другом порядке сложения
+    const double ALLOWABLE_ERROR = 1e-6;
+    double threshold = -std::numeric_limits<double>::infinity();
+    const size_t max_count = top_documents.GetMaxCount();
+    // Куча с наименьшей на вершине: k лучших релевантностей документов текущего списка
+    std::pmr::vector<double> best_scores(GetScratchResource());
+    best_scores.reserve(std::min<size_t>(max_count, MAX_RESULT_DOCUMENT_COUNT));
+    ScopedRelevanceAccumulator document_to_relevance;
+    document_to_relevance->Reset(ordinal_to_document_id_.size(), total_postings);
+    size_t postings_visited = 0;
+    size_t scanned_count = 0;
+    for (; scanned_count < by_impact.size() && remaining_bound[scanned_count] > threshold; ++scanned_count) {
+        const QueryTerm& term = terms[by_impact[scanned_count]];
+        best_scores.clear();
+        term.document_freqs->ForEachImpact(term.inverse_document_freq, [&](int ordinal, double impact) {
+            const DocumentMetadata& metadata = ordinal_to_metadata_[ordinal];
+            if ((has_excluded && excluded.Test(ordinal))
+                    || !document_predicate(ordinal_to_document_id_[ordinal], metadata.status, metadata.rating)) {
+                return;
+            }
+            const double relevance = document_to_relevance->Add(ordinal, impact);
+            if (best_scores.size() < max_count) {
+                best_scores.push_back(relevance);
+                std::push_heap(best_scores.begin(), best_scores.end(), std::greater<>());
+            } else if (max_count > 0 && relevance > best_scores.front()) {
+                std::pop_heap(best_scores.begin(), best_scores.end(), std::greater<>());
+                best_scores.back() = relevance;
+                std::push_heap(best_scores.begin(), best_scores.end(), std::greater<>());
+            }
+        });
+        postings_visited += term.document_freqs->size();
+        if (max_count > 0 && best_scores.size() == max_count) {
+            threshold = std::max(threshold, best_scores.front() - 2 * ALLOWABLE_ERROR);
+        }
+    }
+ 
+    // Кандидаты по возрастанию номера вместе с накопленной релевантностью
+    const double unscanned_bound = remaining_bound[scanned_count];
+    std::pmr::vector<std::pair<int, double>> candidates(GetScratchResource());
+    document_to_relevance->ForEach([&](int ordinal, double relevance) {
+        if (relevance + unscanned_bound > threshold) {
+            candidates.emplace_back(ordinal, relevance);
         }
+    });
+    std::sort(candidates.begin(), candidates.end());
+ 
+    std::pmr::vector<bool> is_scanned(terms.size(), false, GetScratchResource());
+    for (size_t j = 0; j < scanned_count; ++j) {
+        is_scanned[by_impact[j]] = true;
+    }
+    std::pmr::vector<PostingList::Cursor> cursors(GetScratchResource());
+    cursors.reserve(terms.size());
+    for (const QueryTerm& term : terms) {
+        cursors.emplace_back(*term.document_freqs);
     }
+    for (const auto& [ordinal, partial_relevance] : candidates) {
+        if (top_documents.IsFull()) {
+            threshold = std::max(threshold, top_documents.GetWorst().relevance - 2 * ALLOWABLE_ERROR);
+        }
+        // В сжатом списке вклад ограничен ещё и максимумом блока, куда попадает кандидат:
+        // если и с ним документ не проходит порог, блоки не распаковываются
+        double score_bound = partial_relevance + unscanned_bound;
+        for (size_t j = scanned_count; j < by_impact.size() && score_bound > threshold; ++j) {
+            const QueryTerm& term = terms[by_impact[j]];
+            score_bound += cursors[by_impact[j]].GetBlockMaxTermFreq(ordinal) * term.inverse_document_freq - term.max_impact;
+        }
+        if (score_bound <= threshold) {
+            continue;
+        }
  
-    std::vector<Document> matched_documents;
-    for (const auto [document_id, relevance] : document_to_relevance) {
-        matched_documents.push_back(
-            {document_id, relevance, documents_.at(document_id).rating});
+        double relevance = 0.0;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            PostingList::Cursor& cursor = cursors[i];
+            cursor.SeekTo(ordinal);
+            if (!cursor.AtEnd() && cursor.GetDocumentId() == ordinal) {
+                relevance += cursor.GetTermFreq() * terms[i].inverse_document_freq;
+                postings_visited += is_scanned[i] ? 0 : 1;
+            }
+        }
+        top_documents.Add({ordinal_to_document_id_[ordinal], relevance, ordinal_to_metadata_[ordinal].rating});
     }
-    return matched_documents;
-}
\ No newline at end of file
+ 
+    stats.postings_visited += postings_visited;
+    stats.postings_skipped += total_postings - postings_visited;
+}
@@ -0,0 +1,282 @@
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "corpus_generator.h"
+#include "document.h"
+#include "paginator.h"
+#include "remove_duplicates.h"
+#include "search_pager.h"
+#include "search_server.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    CorpusOptions corpus;
+    size_t query_count = 2'000;
+    double minus_ratio = 0.1;
+    PostingFormat posting_format = PostingFormat::PLAIN;
+    std::string output_path;
+};
+
+struct BenchResult {
+    std::string name;
+    std::vector<uint64_t> latencies_ns;
+    uint64_t total_ns = 0;
+    // Дополнительное число для отчёта, например сколько документов удалено
+    std::string extra_name;
+    uint64_t extra_value = 0;
+    long peak_rss_kb = 0;
+};
+
+long GetPeakRssKb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // В Linux ru_maxrss уже в килобайтах
+    return usage.ru_maxrss;
+}
+
+uint64_t ElapsedNs(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+// Выполняет operation(i) для i из [0, count) и замеряет каждый вызов отдельно
+template <typename Operation>
+BenchResult Measure(std::string name, size_t count, Operation operation) {
+    BenchResult result;
+    result.name = std::move(name);
+    result.latencies_ns.reserve(count);
+    const auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        const auto operation_start = Clock::now();
+        operation(i);
+        result.latencies_ns.push_back(ElapsedNs(operation_start));
+    }
+    result.total_ns = ElapsedNs(start);
+    result.peak_rss_kb = GetPeakRssKb();
+    return result;
+}
+
+uint64_t Percentile(const std::vector<uint64_t>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void WriteResult(std::ostream& out, BenchResult result) {
+    std::sort(result.latencies_ns.begin(), result.latencies_ns.end());
+    const size_t operations = result.latencies_ns.size();
+    const double seconds = static_cast<double>(result.total_ns) / 1e9;
+    out << "    {\"name\": \""s << result.name << "\", \"operations\": "s << operations
+        << ", \"total_ms\": "s << static_cast<double>(result.total_ns) / 1e6
+        << ", \"throughput_ops_per_sec\": "s << (seconds > 0 ? operations / seconds : 0.0)
+        << ", \"latency_ns\": {\"p50\": "s << Percentile(result.latencies_ns, 0.50)
+        << ", \"p90\": "s << Percentile(result.latencies_ns, 0.90)
+        << ", \"p99\": "s << Percentile(result.latencies_ns, 0.99)
+        << ", \"max\": "s << (operations == 0 ? 0 : result.latencies_ns.back()) << "}"s;
+    if (!result.extra_name.empty()) {
+        out << ", \""s << result.extra_name << "\": "s << result.extra_value;
+    }
+    out << ", \"peak_rss_kb\": "s << result.peak_rss_kb << "}"s;
+}
+
+// Параметры вида --documents=100000
+BenchOptions ParseOptions(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+        const size_t equals = argument.find('=');
+        if (argument.substr(0, 2) != "--"sv || equals == std::string_view::npos) {
+            throw std::invalid_argument("Ожидается параметр вида --name=value: "s + std::string(argument));
+        }
+        const std::string_view name = argument.substr(2, equals - 2);
+        const std::string value(argument.substr(equals + 1));
+        if (name == "seed"sv) {
+            options.corpus.seed = static_cast<uint32_t>(std::stoul(value));
+        } else if (name == "documents"sv) {
+            options.corpus.document_count = std::stoul(value);
+        } else if (name == "min-words"sv) {
+            options.corpus.min_document_words = std::stoul(value);
+        } else if (name == "max-words"sv) {
+            options.corpus.max_document_words = std::stoul(value);
+        } else if (name == "vocabulary"sv) {
+            options.corpus.vocabulary_size = std::stoul(value);
+        } else if (name == "zipf"sv) {
+            options.corpus.zipf_exponent = std::stod(value);
+        } else if (name == "stop-word-ratio"sv) {
+            options.corpus.stop_word_ratio = std::stod(value);
+        } else if (name == "duplicate-ratio"sv) {
+            options.corpus.duplicate_ratio = std::stod(value);
+        } else if (name == "queries"sv) {
+            options.query_count = std::stoul(value);
+        } else if (name == "minus-ratio"sv) {
+            options.minus_ratio = std::stod(value);
+        } else if (name == "postings"sv) {
+            if (value == "plain"sv) {
+                options.posting_format = PostingFormat::PLAIN;
+            } else if (value == "compressed"sv) {
+                options.posting_format = PostingFormat::COMPRESSED;
+            } else {
+                throw std::invalid_argument("Формат списков документов — plain или compressed: "s + value);
+            }
+        } else if (name == "output"sv) {
+            options.output_path = value;
+        } else {
+            throw std::invalid_argument("Неизвестный параметр: "s + std::string(name));
+        }
+    }
+    return options;
+}
+
+std::vector<BenchResult> RunBenchmarks(const BenchOptions& options) {
+    CorpusGenerator corpus(options.corpus);
+    const std::vector<std::string> documents = corpus.GenerateDocuments();
+    std::vector<std::vector<int>> ratings;
+    ratings.reserve(documents.size());
+    for (size_t i = 0; i < documents.size(); ++i) {
+        ratings.push_back(corpus.GenerateRatings());
+    }
+
+    std::vector<BenchResult> results;
+    SearchServer search_server(corpus.GetStopWords());
+    search_server.SetPostingFormat(options.posting_format);
+    results.push_back(Measure("add_document"s, documents.size(), [&](size_t i) {
+        search_server.AddDocument(static_cast<int>(i), documents[i], DocumentStatus::ACTUAL, ratings[i]);
+    }));
+
+    for (const size_t word_count : {1, 10, 100}) {
+        std::vector<std::string> queries;
+        for (size_t i = 0; i < options.query_count; ++i) {
+            queries.push_back(corpus.GenerateQuery(word_count, word_count == 1 ? 0.0 : options.minus_ratio));
+        }
+        size_t found = 0;
+        BenchResult result = Measure("find_top_documents_"s + std::to_string(word_count) + "_words"s, queries.size(), [&](size_t i) {
+            found += search_server.FindTopDocuments(queries[i]).size();
+        });
+        result.extra_name = "documents_found"s;
+        result.extra_value = found;
+        results.push_back(std::move(result));
+    }
+
+    std::mt19937 generator(options.corpus.seed);
+    std::uniform_int_distribution<int> document_distribution(0, static_cast<int>(documents.size()) - 1);
+    {
+        std::vector<std::string> queries;
+        std::vector<int> document_ids;
+        for (size_t i = 0; i < options.query_count; ++i) {
+            queries.push_back(corpus.GenerateQuery(10, options.minus_ratio));
+            document_ids.push_back(document_distribution(generator));
+        }
+        size_t matched = 0;
+        BenchResult result = Measure("match_document"s, queries.size(), [&](size_t i) {
+            matched += std::get<0>(search_server.MatchDocument(queries[i], document_ids[i])).size();
+        });
+        result.extra_name = "words_matched"s;
+        result.extra_value = matched;
+        results.push_back(std::move(result));
+    }
+
+    {
+        // Длинные выдачи, чтобы разбиение на страницы было заметно
+        std::vector<std::string> queries;
+        std::vector<std::vector<Document>> found_documents;
+        for (size_t i = 0; i < options.query_count; ++i) {
+            queries.push_back(corpus.GenerateQuery(3, 0.0));
+            found_documents.push_back(search_server.FindTopDocuments(queries.back(), DocumentStatus::ACTUAL, 1'000));
+        }
+        // Страницы строятся при обходе, поэтому замеряется обход всех страниц, а не только их подсчёт
+        size_t paged_document_count = 0;
+        BenchResult result = Measure("paginate"s, found_documents.size(), [&](size_t i) {
+            for (const auto page : Paginate(found_documents[i], 10)) {
+                paged_document_count += page.size();
+            }
+        });
+        result.extra_name = "documents_paged"s;
+        result.extra_value = paged_document_count;
+        results.push_back(std::move(result));
+
+        // Глубокая страница без предыдущих: SearchPager отбирает её одним проходом по индексу
+        const size_t deep_page = 50;
+        size_t deep_page_documents = 0;
+        BenchResult pager_result = Measure("search_pager_page_"s + std::to_string(deep_page), queries.size(), [&](size_t i) {
+            SearchPager pager(search_server, queries[i], DocumentStatus::ACTUAL, 10);
+            deep_page_documents += pager.GetPage(deep_page).size();
+        });
+        pager_result.extra_name = "documents_found"s;
+        pager_result.extra_value = deep_page_documents;
+        results.push_back(std::move(pager_result));
+    }
+
+    {
+        const int document_count_before = search_server.GetDocumentCount();
+        BenchResult result = Measure("remove_duplicates"s, 1, [&]([[maybe_unused]] size_t i) {
+            RemoveDuplicates(search_server);
+        });
+        result.extra_name = "documents_removed"s;
+        result.extra_value = document_count_before - search_server.GetDocumentCount();
+        results.push_back(std::move(result));
+    }
+
+    {
+        // Удаляется десятая часть оставшихся документов в случайном порядке
+        std::vector<int> document_ids(search_server.begin(), search_server.end());
+        std::shuffle(document_ids.begin(), document_ids.end(), generator);
+        document_ids.resize(document_ids.size() / 10);
+        results.push_back(Measure("remove_document"s, document_ids.size(), [&](size_t i) {
+            search_server.RemoveDocument(document_ids[i]);
+        }));
+    }
+    return results;
+}
+
+void WriteReport(std::ostream& out, const BenchOptions& options, std::vector<BenchResult> results) {
+    const CorpusOptions& corpus = options.corpus;
+    out << "{\n  \"config\": {\"seed\": "s << corpus.seed << ", \"documents\": "s << corpus.document_count
+        << ", \"min_words\": "s << corpus.min_document_words << ", \"max_words\": "s << corpus.max_document_words
+        << ", \"vocabulary\": "s << corpus.vocabulary_size << ", \"zipf\": "s << corpus.zipf_exponent
+        << ", \"stop_word_ratio\": "s << corpus.stop_word_ratio << ", \"duplicate_ratio\": "s << corpus.duplicate_ratio
+        << ", \"queries\": "s << options.query_count << ", \"minus_ratio\": "s << options.minus_ratio
+        << ", \"postings\": \""s << (options.posting_format == PostingFormat::COMPRESSED ? "compressed"s : "plain"s) << "\"},\n"s;
+    out << "  \"benchmarks\": [\n"s;
+    for (size_t i = 0; i < results.size(); ++i) {
+        WriteResult(out, std::move(results[i]));
+        out << (i + 1 < results.size() ? ",\n"s : "\n"s);
+    }
+    out << "  ],\n  \"peak_rss_kb\": "s << GetPeakRssKb() << "\n}\n"s;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const BenchOptions options = ParseOptions(argc, argv);
+        std::vector<BenchResult> results = RunBenchmarks(options);
+        if (options.output_path.empty()) {
+            WriteReport(std::cout, options, std::move(results));
+        } else {
+            std::ofstream out(options.output_path);
+            WriteReport(out, options, std::move(results));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+#include "shard_protocol.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "document.h"
+#include "search_server.h"
+
+using namespace std::literals;
+
+namespace {
+
+enum class ResponseStatus : uint8_t {
+    OK = 0,
+    INVALID_ARGUMENT,
+    OUT_OF_RANGE,
+    RUNTIME_ERROR,
+};
+
+// Проверяет статус ответа и возвращает читатель, стоящий на его теле
+MessageReader OpenResponse(std::string_view response) {
+    MessageReader reader(response);
+    const auto status = static_cast<ResponseStatus>(reader.ReadUint8());
+    if (status == ResponseStatus::OK) {
+        return reader;
+    }
+    const std::string message(reader.ReadString());
+    switch (status) {
+        case ResponseStatus::INVALID_ARGUMENT:
+            throw std::invalid_argument(message);
+        case ResponseStatus::OUT_OF_RANGE:
+            throw std::out_of_range(message);
+        default:
+            throw std::runtime_error(message);
+    }
+}
+
+std::string EncodeErrorResponse(ResponseStatus status, std::string_view message) {
+    MessageWriter writer;
+    writer.WriteUint8(static_cast<uint8_t>(status));
+    writer.WriteString(message);
+    return writer.Release();
+}
+
+MessageWriter StartRequest(ShardRequestType type) {
+    MessageWriter writer;
+    writer.WriteUint8(static_cast<uint8_t>(type));
+    return writer;
+}
+
+MessageWriter StartOkResponse() {
+    MessageWriter writer;
+    writer.WriteUint8(static_cast<uint8_t>(ResponseStatus::OK));
+    return writer;
+}
+
+DocumentStatus ReadDocumentStatus(MessageReader& reader) {
+    const uint8_t status = reader.ReadUint8();
+    if (status >= DOCUMENT_STATUS_COUNT) {
+        throw std::runtime_error("Некорректный статус документа в сообщении шарда"s);
+    }
+    return static_cast<DocumentStatus>(status);
+}
+
+}  // namespace
+
+void MessageWriter::WriteUint8(uint8_t value) {
+    buffer_.push_back(static_cast<char>(value));
+}
+
+void MessageWriter::WriteInt32(int32_t value) {
+    WriteBytes(&value, sizeof(value));
+}
+
+void MessageWriter::WriteUint64(uint64_t value) {
+    WriteBytes(&value, sizeof(value));
+}
+
+void MessageWriter::WriteDouble(double value) {
+    WriteBytes(&value, sizeof(value));
+}
+
+void MessageWriter::WriteString(std::string_view value) {
+    WriteUint64(value.size());
+    buffer_.append(value);
+}
+
+std::string MessageWriter::Release() {
+    return std::move(buffer_);
+}
+
+void MessageWriter::WriteBytes(const void* data, size_t size) {
+    buffer_.append(static_cast<const char*>(data), size);
+}
+
+MessageReader::MessageReader(std::string_view message)
+    : message_(message) {
+}
+
+uint8_t MessageReader::ReadUint8() {
+    uint8_t value = 0;
+    ReadBytes(&value, sizeof(value));
+    return value;
+}
+
+int32_t MessageReader::ReadInt32() {
+    int32_t value = 0;
+    ReadBytes(&value, sizeof(value));
+    return value;
+}
+
+uint64_t MessageReader::ReadUint64() {
+    uint64_t value = 0;
+    ReadBytes(&value, sizeof(value));
+    return value;
+}
+
+double MessageReader::ReadDouble() {
+    double value = 0.0;
+    ReadBytes(&value, sizeof(value));
+    return value;
+}
+
+std::string_view MessageReader::ReadString() {
+    const uint64_t size = ReadUint64();
+    if (size > message_.size()) {
+        throw std::runtime_error("Сообщение шарда обрезано"s);
+    }
+    const std::string_view value = message_.substr(0, size);
+    message_.remove_prefix(size);
+    return value;
+}
+
+bool MessageReader::AtEnd() const {
+    return message_.empty();
+}
+
+void MessageReader::ReadBytes(void* data, size_t size) {
+    if (size > message_.size()) {
+        throw std::runtime_error("Сообщение шарда обрезано"s);
+    }
+    std::memcpy(data, message_.data(), size);
+    message_.remove_prefix(size);
+}
+
+ShardRequestType GetShardRequestType(std::string_view request) {
+    if (request.empty()) {
+        throw std::runtime_error("Пустой запрос к шарду"s);
+    }
+    return static_cast<ShardRequestType>(request.front());
+}
+
+bool IsReadOnlyShardRequest(std::string_view request) {
+    const ShardRequestType type = GetShardRequestType(request);
+    return type != ShardRequestType::ADD_DOCUMENT && type != ShardRequestType::REMOVE_DOCUMENT;
+}
+
+std::string EncodeAddDocumentRequest(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    MessageWriter writer = StartRequest(ShardRequestType::ADD_DOCUMENT);
+    writer.WriteInt32(document_id);
+    writer.WriteString(document);
+    writer.WriteUint8(static_cast<uint8_t>(status));
+    writer.WriteUint64(ratings.size());
+    for (const int rating : ratings) {
+        writer.WriteInt32(rating);
+    }
+    return writer.Release();
+}
+
+std::string EncodeRemoveDocumentRequest(int document_id) {
+    MessageWriter writer = StartRequest(ShardRequestType::REMOVE_DOCUMENT);
+    writer.WriteInt32(document_id);
+    return writer.Release();
+}
+
+std::string EncodeGetDocumentCountRequest() {
+    return StartRequest(ShardRequestType::GET_DOCUMENT_COUNT).Release();
+}
+
+std::string EncodeCollectStatisticsRequest(std::string_view raw_query) {
+    MessageWriter writer = StartRequest(ShardRequestType::COLLECT_STATISTICS);
+    writer.WriteString(raw_query);
+    return writer.Release();
+}
+
+std::string EncodeFindTopDocumentsRequest(std::string_view raw_query, DocumentStatus status, size_t max_count,
+                                          const CollectionStatistics& collection) {
+    MessageWriter writer = StartRequest(ShardRequestType::FIND_TOP_DOCUMENTS);
+    writer.WriteString(raw_query);
+    writer.WriteUint8(static_cast<uint8_t>(status));
+    writer.WriteUint64(max_count);
+    writer.WriteUint64(collection.document_count);
+    writer.WriteUint64(collection.document_freqs.size());
+    for (const auto& [word, document_freq] : collection.document_freqs) {
+        writer.WriteString(word);
+        writer.WriteUint64(document_freq);
+    }
+    return writer.Release();
+}
+
+std::string EncodeMatchDocumentRequest(std::string_view raw_query, int document_id) {
+    MessageWriter writer = StartRequest(ShardRequestType::MATCH_DOCUMENT);
+    writer.WriteString(raw_query);
+    writer.WriteInt32(document_id);
+    return writer.Release();
+}
+
+void DecodeEmptyResponse(std::string_view response) {
+    OpenResponse(response);
+}
+
+int DecodeDocumentCountResponse(std::string_view response) {
+    MessageReader reader = OpenResponse(response);
+    return reader.ReadInt32();
+}
+
+void AddCollectStatisticsResponse(std::string_view response, CollectionStatistics& collection) {
+    MessageReader reader = OpenResponse(response);
+    collection.document_count += reader.ReadUint64();
+    const uint64_t word_count = reader.ReadUint64();
+    for (uint64_t i = 0; i < word_count; ++i) {
+        const std::string_view word = reader.ReadString();
+        const uint64_t document_freq = reader.ReadUint64();
+        if (const auto it = collection.document_freqs.find(word); it != collection.document_freqs.end()) {
+            it->second += document_freq;
+        } else {
+            collection.document_freqs.emplace(word, document_freq);
+        }
+    }
+}
+
+std::vector<Document> DecodeFindTopDocumentsResponse(std::string_view response) {
+    MessageReader reader = OpenResponse(response);
+    std::vector<Document> documents(reader.ReadUint64());
+    for (Document& document : documents) {
+        document.id = reader.ReadInt32();
+        document.relevance = reader.ReadDouble();
+        document.rating = reader.ReadInt32();
+    }
+    return documents;
+}
+
+std::tuple<std::vector<std::string>, DocumentStatus> DecodeMatchDocumentResponse(std::string_view response) {
+    MessageReader reader = OpenResponse(response);
+    const DocumentStatus status = ReadDocumentStatus(reader);
+    std::vector<std::string> words(reader.ReadUint64());
+    for (std::string& word : words) {
+        word = reader.ReadString();
+    }
+    return {words, status};
+}
+
+ShardService::ShardService(SearchServer& server)
+    : server_(server) {
+}
+
+std::string ShardService::Handle(std::string_view request) {
+    try {
+        return HandleRequest(request);
+    } catch (const std::invalid_argument& e) {
+        return EncodeErrorResponse(ResponseStatus::INVALID_ARGUMENT, e.what());
+    } catch (const std::out_of_range& e) {
+        return EncodeErrorResponse(ResponseStatus::OUT_OF_RANGE, e.what());
+    } catch (const std::exception& e) {
+        return EncodeErrorResponse(ResponseStatus::RUNTIME_ERROR, e.what());
+    }
+}
+
+std::string ShardService::HandleRequest(std::string_view request) {
+    MessageReader reader(request);
+    const auto type = static_cast<ShardRequestType>(reader.ReadUint8());
+    MessageWriter writer = StartOkResponse();
+    switch (type) {
+        case ShardRequestType::ADD_DOCUMENT: {
+            const int document_id = reader.ReadInt32();
+            const std::string_view document = reader.ReadString();
+            const DocumentStatus status = ReadDocumentStatus(reader);
+            std::vector<int> ratings(reader.ReadUint64());
+            for (int& rating : ratings) {
+                rating = reader.ReadInt32();
+            }
+            server_.AddDocument(document_id, document, status, ratings);
+            break;
+        }
+        case ShardRequestType::REMOVE_DOCUMENT:
+            server_.RemoveDocument(reader.ReadInt32());
+            break;
+        case ShardRequestType::GET_DOCUMENT_COUNT:
+            writer.WriteInt32(server_.GetDocumentCount());
+            break;
+        case ShardRequestType::COLLECT_STATISTICS: {
+            CollectionStatistics collection;
+            server_.AddCollectionStatistics(reader.ReadString(), collection);
+            writer.WriteUint64(collection.document_count);
+            writer.WriteUint64(collection.document_freqs.size());
+            for (const auto& [word, document_freq] : collection.document_freqs) {
+                writer.WriteString(word);
+                writer.WriteUint64(document_freq);
+            }
+            break;
+        }
+        case ShardRequestType::FIND_TOP_DOCUMENTS: {
+            const std::string_view raw_query = reader.ReadString();
+            const DocumentStatus status = ReadDocumentStatus(reader);
+            const size_t max_count = reader.ReadUint64();
+            CollectionStatistics collection;
+            collection.document_count = reader.ReadUint64();
+            const uint64_t word_count = reader.ReadUint64();
+            for (uint64_t i = 0; i < word_count; ++i) {
+                const std::string_view word = reader.ReadString();
+                collection.document_freqs.emplace(word, reader.ReadUint64());
+            }
+            const auto documents = server_.FindTopDocuments(raw_query,
+                [status]([[maybe_unused]] int document_id, DocumentStatus document_status, [[maybe_unused]] int rating) {
+                    return document_status == status;
+                }, max_count, collection);
+            writer.WriteUint64(documents.size());
+            for (const Document& document : documents) {
+                writer.WriteInt32(document.id);
+                writer.WriteDouble(document.relevance);
+                writer.WriteInt32(document.rating);
+            }
+            break;
+        }
+        case ShardRequestType::MATCH_DOCUMENT: {
+            const std::string_view raw_query = reader.ReadString();
+            const auto [words, status] = server_.MatchDocument(raw_query, reader.ReadInt32());
+            writer.WriteUint8(static_cast<uint8_t>(status));
+            writer.WriteUint64(words.size());
+            for (std::string_view word : words) {
+                writer.WriteString(word);
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error("Неизвестный запрос к шарду"s);
+    }
+    return writer.Release();
+}
\ No newline at end of file
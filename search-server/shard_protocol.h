@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "document.h"
+#include "search_server.h"
+
+// Сообщения между ShardedSearchServer и шардами. Запрос и ответ — непрерывные строки байтов без указателей,
+// поэтому их можно передать через сокет или канал так же, как внутри процесса.
+// Числа записываются в порядке байтов машины: обе стороны пока работают на одной машине
+enum class ShardRequestType : uint8_t {
+    ADD_DOCUMENT = 1,
+    REMOVE_DOCUMENT,
+    GET_DOCUMENT_COUNT,
+    // Число документов шарда и частоты плюс-слов запроса — для общего IDF
+    COLLECT_STATISTICS,
+    // Лучшие документы шарда с IDF по статистике всех шардов
+    FIND_TOP_DOCUMENTS,
+    MATCH_DOCUMENT,
+};
+
+class MessageWriter {
+public:
+    void WriteUint8(uint8_t value);
+
+    void WriteInt32(int32_t value);
+
+    void WriteUint64(uint64_t value);
+
+    void WriteDouble(double value);
+
+    void WriteString(std::string_view value);
+
+    std::string Release();
+
+private:
+    std::string buffer_;
+
+    void WriteBytes(const void* data, size_t size);
+};
+
+// Бросает std::runtime_error, если сообщение короче, чем ожидается
+class MessageReader {
+public:
+    explicit MessageReader(std::string_view message);
+
+    uint8_t ReadUint8();
+
+    int32_t ReadInt32();
+
+    uint64_t ReadUint64();
+
+    double ReadDouble();
+
+    std::string_view ReadString();
+
+    bool AtEnd() const;
+
+private:
+    std::string_view message_;
+
+    void ReadBytes(void* data, size_t size);
+};
+
+ShardRequestType GetShardRequestType(std::string_view request);
+
+// Запросы, которые не меняют индекс шарда и могут выполняться одновременно
+bool IsReadOnlyShardRequest(std::string_view request);
+
+std::string EncodeAddDocumentRequest(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+std::string EncodeRemoveDocumentRequest(int document_id);
+
+std::string EncodeGetDocumentCountRequest();
+
+std::string EncodeCollectStatisticsRequest(std::string_view raw_query);
+
+std::string EncodeFindTopDocumentsRequest(std::string_view raw_query, DocumentStatus status, size_t max_count,
+                                          const CollectionStatistics& collection);
+
+std::string EncodeMatchDocumentRequest(std::string_view raw_query, int document_id);
+
+// Разбор ответов. Если шард ответил ошибкой, бросается исключение того же вида, что и у SearchServer:
+// std::invalid_argument, std::out_of_range или std::runtime_error
+void DecodeEmptyResponse(std::string_view response);
+
+int DecodeDocumentCountResponse(std::string_view response);
+
+// Прибавляет статистику шарда к общей
+void AddCollectStatisticsResponse(std::string_view response, CollectionStatistics& collection);
+
+std::vector<Document> DecodeFindTopDocumentsResponse(std::string_view response);
+
+std::tuple<std::vector<std::string>, DocumentStatus> DecodeMatchDocumentResponse(std::string_view response);
+
+// Сторона шарда: выполняет запрос над своим SearchServer и кодирует ответ.
+// Исключения SearchServer не выходят наружу, а передаются в ответе
+class ShardService {
+public:
+    explicit ShardService(SearchServer& server);
+
+    std::string Handle(std::string_view request);
+
+private:
+    SearchServer& server_;
+
+    std::string HandleRequest(std::string_view request);
+};
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "sharded_search_server.h"
+#include <algorithm>
+#include <execution>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "document_fingerprint.h"
+#include "top_documents.h"
+
+using namespace std::literals;
+
+LocalShardChannel::LocalShardChannel(std::string_view stop_words)
+    : server_(stop_words)
+    , service_(server_) {
+}
+
+std::string LocalShardChannel::Exchange(std::string_view request) {
+    if (IsReadOnlyShardRequest(request)) {
+        std::shared_lock lock(mutex_);
+        return service_.Handle(request);
+    }
+    std::unique_lock lock(mutex_);
+    return service_.Handle(request);
+}
+
+ShardedSearchServer::ShardedSearchServer(std::string_view stop_words, size_t shard_count) {
+    if (shard_count == 0) {
+        throw std::invalid_argument("Число шардов должно быть положительным"s);
+    }
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<LocalShardChannel>(stop_words));
+    }
+}
+
+ShardedSearchServer::ShardedSearchServer(std::vector<std::unique_ptr<ShardChannel>> shards)
+    : shards_(std::move(shards)) {
+    if (shards_.empty() || std::any_of(shards_.begin(), shards_.end(), [](const auto& shard) { return shard == nullptr; })) {
+        throw std::invalid_argument("Нужен хотя бы один шард"s);
+    }
+}
+
+void ShardedSearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    // Повтор id проверяет сам шард: документ с тем же id всегда попадает в тот же шард
+    DecodeEmptyResponse(shards_[GetShardIndex(document_id)]->Exchange(EncodeAddDocumentRequest(document_id, document, status, ratings)));
+}
+
+void ShardedSearchServer::RemoveDocument(int document_id) {
+    DecodeEmptyResponse(shards_[GetShardIndex(document_id)]->Exchange(EncodeRemoveDocumentRequest(document_id)));
+}
+
+int ShardedSearchServer::GetDocumentCount() const {
+    int document_count = 0;
+    for (const std::string& response : Broadcast(EncodeGetDocumentCountRequest())) {
+        document_count += DecodeDocumentCountResponse(response);
+    }
+    return document_count;
+}
+
+std::vector<Document> ShardedSearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status, size_t max_count) const {
+    CollectionStatistics collection;
+    for (const std::string& response : Broadcast(EncodeCollectStatisticsRequest(raw_query))) {
+        AddCollectStatisticsResponse(response, collection);
+    }
+
+    TopDocuments top_documents(max_count);
+    for (const std::string& response : Broadcast(EncodeFindTopDocumentsRequest(raw_query, status, max_count, collection))) {
+        for (const Document& document : DecodeFindTopDocumentsResponse(response)) {
+            top_documents.Add(document);
+        }
+    }
+    return top_documents.Extract();
+}
+
+std::tuple<std::vector<std::string>, DocumentStatus> ShardedSearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
+    return DecodeMatchDocumentResponse(shards_[GetShardIndex(document_id)]->Exchange(EncodeMatchDocumentRequest(raw_query, document_id)));
+}
+
+size_t ShardedSearchServer::GetShardCount() const {
+    return shards_.size();
+}
+
+size_t ShardedSearchServer::GetShardIndex(int document_id) const {
+    // Последовательные id перемешиваются, чтобы шарды заполнялись равномерно
+    return MixHash(static_cast<uint64_t>(static_cast<uint32_t>(document_id))) % shards_.size();
+}
+
+std::vector<std::string> ShardedSearchServer::Broadcast(const std::string& request) const {
+    std::vector<std::string> responses(shards_.size());
+    std::transform(std::execution::par, shards_.begin(), shards_.end(), responses.begin(),
+                   [&request](const std::unique_ptr<ShardChannel>& shard) {
+                       return shard->Exchange(request);
+                   });
+    return responses;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "document.h"
+#include "search_server.h"
+#include "shard_protocol.h"
+
+// Канал до одного шарда: отправляет закодированный запрос и возвращает закодированный ответ.
+// Exchange могут вызывать из нескольких потоков сразу
+class ShardChannel {
+public:
+    virtual ~ShardChannel() = default;
+
+    virtual std::string Exchange(std::string_view request) = 0;
+};
+
+// Шард в том же процессе. Запросы на чтение выполняются параллельно, изменения — по одному
+class LocalShardChannel : public ShardChannel {
+public:
+    explicit LocalShardChannel(std::string_view stop_words);
+
+    std::string Exchange(std::string_view request) override;
+
+private:
+    std::shared_mutex mutex_;
+    SearchServer server_;
+    ShardService service_;
+};
+
+// Документы распределены по шардам по хешу id. Запрос выполняется в два круга по всем шардам параллельно:
+// сначала собирается общее число документов и частоты слов запроса, затем каждый шард ищет лучшие документы
+// с IDF по этой общей статистике, и их списки сливаются в общий топ. Поэтому релевантность совпадает
+// с единым индексом. Произвольный предикат через сообщения не передаётся, фильтр — только по статусу
+class ShardedSearchServer {
+public:
+    // shard_count шардов в этом процессе
+    ShardedSearchServer(std::string_view stop_words, size_t shard_count);
+
+    explicit ShardedSearchServer(std::vector<std::unique_ptr<ShardChannel>> shards);
+
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    void RemoveDocument(int document_id);
+
+    int GetDocumentCount() const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL,
+                                           size_t max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    // Слова копируются из ответа шарда, поэтому возвращаются строками, а не string_view
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+
+    size_t GetShardCount() const;
+
+    // Шард, в котором хранится документ с этим id
+    size_t GetShardIndex(int document_id) const;
+
+private:
+    std::vector<std::unique_ptr<ShardChannel>> shards_;
+
+    // Отправляет один и тот же запрос всем шардам параллельно
+    std::vector<std::string> Broadcast(const std::string& request) const;
+};
\ No newline at end of file
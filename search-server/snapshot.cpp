@@ -0,0 +1,158 @@
+#include "snapshot.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'S', 'R', 'C', 'H', 'S', 'N', 'A', 'P'};
+const uint32_t SNAPSHOT_VERSION = 1;
+const uint32_t SNAPSHOT_BYTE_ORDER_MARK = 0x01020304;
+
+// FNV-1a по 64-битным словам: полезная нагрузка всегда кратна 8 байтам
+uint64_t ComputeChecksum(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t offset = 0; offset < size; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + offset, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    return hash;
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Не удалось открыть файл снимка "s + path);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        throw std::runtime_error("Не удалось узнать размер файла снимка "s + path);
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ > 0) {
+        void* address = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Не удалось отобразить в память файл снимка "s + path);
+        }
+        data_ = static_cast<const char*>(address);
+    }
+    // Отображение остаётся действительным и после закрытия дескриптора
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+const char* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+void SnapshotWriter::WriteStrings(const std::vector<std::string_view>& strings) {
+    std::vector<uint64_t> offsets;
+    offsets.reserve(strings.size() + 1);
+    offsets.push_back(0);
+    for (std::string_view str : strings) {
+        offsets.push_back(offsets.back() + str.size());
+    }
+    WriteArray(offsets);
+
+    std::string chars;
+    chars.reserve(offsets.back());
+    for (std::string_view str : strings) {
+        chars += str;
+    }
+    WriteArray(chars.data(), chars.size());
+}
+
+void SnapshotWriter::Save(const std::string& path, SnapshotHeader header) const {
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order_mark = SNAPSHOT_BYTE_ORDER_MARK;
+    header.payload_size = payload_.size();
+    header.checksum = ComputeChecksum(payload_.data(), payload_.size());
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(payload_.data(), payload_.size());
+    if (!output) {
+        throw std::runtime_error("Не удалось записать файл снимка "s + path);
+    }
+}
+
+SnapshotReader::SnapshotReader(const MappedFile& file)
+    : file_(file)
+    , position_(sizeof(SnapshotHeader)) {
+    if (file_.size() < sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Файл снимка короче заголовка"s);
+    }
+    const SnapshotHeader& header = GetHeader();
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Файл не является снимком поискового индекса"s);
+    }
+    if (header.version != SNAPSHOT_VERSION || header.byte_order_mark != SNAPSHOT_BYTE_ORDER_MARK) {
+        throw std::runtime_error("Неподдерживаемая версия или порядок байтов снимка"s);
+    }
+    if (header.payload_size != file_.size() - sizeof(SnapshotHeader) || header.payload_size % sizeof(uint64_t) != 0) {
+        throw std::runtime_error("Размер файла снимка не совпадает с заголовком"s);
+    }
+    if (ComputeChecksum(file_.data() + sizeof(SnapshotHeader), header.payload_size) != header.checksum) {
+        throw std::runtime_error("Контрольная сумма снимка не совпадает"s);
+    }
+}
+
+const SnapshotHeader& SnapshotReader::GetHeader() const {
+    return *reinterpret_cast<const SnapshotHeader*>(file_.data());
+}
+
+std::vector<std::string_view> SnapshotReader::ReadStrings(size_t count) {
+    if (count >= file_.size()) {
+        throw std::runtime_error("Секция выходит за границы файла снимка"s);
+    }
+    const uint64_t* offsets = ReadArray<uint64_t>(count + 1);
+    const char* chars = ReadArray<char>(offsets[count]);
+    CheckOffsets(offsets, count, offsets[count]);
+
+    std::vector<std::string_view> strings;
+    strings.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        strings.emplace_back(chars + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    return strings;
+}
+
+void SnapshotReader::CheckOffsets(const uint64_t* offsets, size_t count, uint64_t total) {
+    if (offsets[0] != 0 || offsets[count] != total || !std::is_sorted(offsets, offsets + count + 1)) {
+        throw std::runtime_error("Повреждена таблица смещений снимка"s);
+    }
+}
+
+const char* SnapshotReader::Read(size_t count, size_t element_size) {
+    // Сравнение через деление не переполняется даже при испорченном count
+    if (count > (file_.size() - position_) / element_size) {
+        throw std::runtime_error("Секция выходит за границы файла снимка"s);
+    }
+    const char* data = file_.data() + position_;
+    position_ = std::min(file_.size(), position_ + (count * element_size + 7) / 8 * 8);
+    return data;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Двоичный снимок индекса: заголовок и массивы фиксированного формата, каждый выровнен по 8 байт.
+// Числа хранятся в порядке байтов машины, записавшей снимок, поэтому читаются без разбора
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint64_t payload_size;
+    uint64_t checksum;
+    uint64_t stop_word_count;
+    uint64_t term_count;
+    uint64_t posting_count;
+    uint64_t document_count;
+    uint64_t forward_term_count;
+};
+
+static_assert(sizeof(SnapshotHeader) % 8 == 0, "Snapshot sections must stay 8-byte aligned");
+static_assert(sizeof(int) == 4 && sizeof(double) == 8, "Snapshot format assumes 32-bit int and 64-bit double");
+
+// Файл, отображённый в память только для чтения
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    const char* data() const;
+
+    size_t size() const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Собирает секции снимка в памяти и записывает их в файл одним куском
+class SnapshotWriter {
+public:
+    template <typename T>
+    void WriteArray(const T* data, size_t count);
+
+    template <typename T>
+    void WriteArray(const std::vector<T>& data) {
+        WriteArray(data.data(), data.size());
+    }
+
+    // Таблица строк: count + 1 смещений, затем символы всех строк подряд
+    void WriteStrings(const std::vector<std::string_view>& strings);
+
+    // Дописывает в заголовок сигнатуру, размер и контрольную сумму
+    void Save(const std::string& path, SnapshotHeader header) const;
+
+private:
+    std::vector<char> payload_;
+};
+
+// Читает секции снимка в том же порядке, в каком их записал SnapshotWriter.
+// Возвращаемые указатели и string_view ссылаются прямо на отображённый файл
+class SnapshotReader {
+public:
+    // Проверяет сигнатуру, версию, порядок байтов и контрольную сумму
+    explicit SnapshotReader(const MappedFile& file);
+
+    const SnapshotHeader& GetHeader() const;
+
+    template <typename T>
+    const T* ReadArray(size_t count);
+
+    std::vector<std::string_view> ReadStrings(size_t count);
+
+    // Проверяет, что count + 1 смещений неубывают и делят массив длины total без остатка
+    static void CheckOffsets(const uint64_t* offsets, size_t count, uint64_t total);
+
+private:
+    const MappedFile& file_;
+    size_t position_;
+
+    const char* Read(size_t count, size_t element_size);
+};
+
+template <typename T>
+void SnapshotWriter::WriteArray(const T* data, size_t count) {
+    const char* bytes = reinterpret_cast<const char*>(data);
+    payload_.insert(payload_.end(), bytes, bytes + count * sizeof(T));
+    payload_.resize((payload_.size() + 7) / 8 * 8, '\0');
+}
+
+template <typename T>
+const T* SnapshotReader::ReadArray(size_t count) {
+    return reinterpret_cast<const T*>(Read(count, sizeof(T)));
+}
\ No newline at end of file
@@ -1,27 +1,18 @@
 #include "string_processing.h"
 #include "document.h"
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using namespace std::literals;
 
-std::vector<std::string> SplitIntoWords(const std::string& text) {
-    std::vector<std::string> words;
-    std::string word;
-    for (const char c : text) {
-        if (c == ' ') {
-            if (!word.empty()) {
-                words.push_back(word);
-                word.clear();
-            }
-        } else {
-            word += c;
-        }
-    }
-    if (!word.empty()) {
+std::vector<std::string_view> SplitIntoWords(std::string_view text) {
+    std::vector<std::string_view> words;
+    words.reserve(std::count(text.begin(), text.end(), ' ') + 1);
+    ForEachWord(text, [&words](std::string_view word) {
         words.push_back(word);
-    }
-
+    });
     return words;
 }
\ No newline at end of file
@@ -3,19 +3,38 @@
 #include "document.h"
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 
 using namespace std::literals;
 
-std::vector<std::string> SplitIntoWords(const std::string& text);
+std::vector<std::string_view> SplitIntoWords(std::string_view text);
+
+// Вызывает callback для каждого слова text по порядку, не собирая их в вектор
+template <typename Callback>
+void ForEachWord(std::string_view text, Callback callback) {
+    while (true) {
+        const size_t word_begin = text.find_first_not_of(' ');
+        if (word_begin == std::string_view::npos) {
+            return;
+        }
+        text.remove_prefix(word_begin);
+        const size_t word_end = text.find(' ');
+        callback(text.substr(0, word_end));
+        if (word_end == std::string_view::npos) {
+            return;
+        }
+        text.remove_prefix(word_end);
+    }
+}
 
 template <typename StringContainer>
-std::set<std::string> MakeUniqueNonEmptyStrings(const StringContainer& strings) {
-    std::set<std::string> non_empty_strings;
-    for (const std::string& str : strings) {
+std::set<std::string, std::less<>> MakeUniqueNonEmptyStrings(const StringContainer& strings) {
+    std::set<std::string, std::less<>> non_empty_strings;
+    for (std::string_view str : strings) {
         if (!str.empty()) {
-            non_empty_strings.insert(str);
+            non_empty_strings.emplace(str);
         }
     }
     return non_empty_strings;
@@ -0,0 +1,62 @@
+#include "term_dictionary.h"
+#include <string>
+#include <string_view>
+#include <utility>
+
+TermDictionary::TermDictionary(const TermDictionary& other) {
+    terms_.reserve(other.terms_.size());
+    ids_.reserve(other.ids_.size());
+    for (std::string_view term : other.terms_) {
+        Intern(term);
+    }
+}
+
+TermDictionary& TermDictionary::operator=(const TermDictionary& other) {
+    if (this != &other) {
+        TermDictionary copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+TermDictionary::TermId TermDictionary::Intern(std::string_view term) {
+    if (const auto it = ids_.find(term); it != ids_.end()) {
+        return it->second;
+    }
+    return InternExternal(owned_terms_.emplace_back(term));
+}
+
+TermDictionary::TermId TermDictionary::InternExternal(std::string_view term) {
+    const auto [it, inserted] = ids_.emplace(term, static_cast<TermId>(terms_.size()));
+    if (inserted) {
+        terms_.push_back(term);
+    }
+    return it->second;
+}
+
+TermDictionary::TermId TermDictionary::Find(std::string_view term) const {
+    const auto it = ids_.find(term);
+    return it == ids_.end() ? NO_TERM : it->second;
+}
+
+std::string_view TermDictionary::GetTerm(TermId id) const {
+    return terms_.at(id);
+}
+
+size_t TermDictionary::GetTermCount() const {
+    return terms_.size();
+}
+
+size_t TermDictionary::GetMemoryUsage() const {
+    size_t bytes = terms_.capacity() * sizeof(std::string_view) + owned_terms_.size() * sizeof(std::string);
+    for (const std::string& term : owned_terms_) {
+        // Короткие строки хранятся внутри самого объекта std::string
+        if (term.capacity() > std::string().capacity()) {
+            bytes += term.capacity() + 1;
+        }
+    }
+    // Узел unordered_map: указатель на следующий узел, пара ключ-значение и кешированный хеш
+    bytes += ids_.size() * (sizeof(void*) + sizeof(std::pair<const std::string_view, TermId>) + sizeof(size_t));
+    bytes += ids_.bucket_count() * sizeof(void*);
+    return bytes;
+}
\ No newline at end of file
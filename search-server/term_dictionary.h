@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Словарь терминов: каждое слово хранится один раз и получает плотный числовой id.
+// Id выдаются подряд с нуля, поэтому по ним можно индексировать обычные векторы
+class TermDictionary {
+public:
+    using TermId = uint32_t;
+
+    static constexpr TermId NO_TERM = std::numeric_limits<TermId>::max();
+
+    TermDictionary() = default;
+
+    // Копия владеет текстом всех слов: string_view оригинала ссылаются на его строки
+    TermDictionary(const TermDictionary& other);
+
+    TermDictionary& operator=(const TermDictionary& other);
+
+    TermDictionary(TermDictionary&&) = default;
+
+    TermDictionary& operator=(TermDictionary&&) = default;
+
+    // Возвращает id слова, добавляя его в словарь при первой встрече
+    TermId Intern(std::string_view term);
+
+    // То же, но без копирования текста: память под слово должна жить дольше словаря
+    TermId InternExternal(std::string_view term);
+
+    // Возвращает NO_TERM, если слова нет в словаре
+    TermId Find(std::string_view term) const;
+
+    std::string_view GetTerm(TermId id) const;
+
+    size_t GetTermCount() const;
+
+    // Оценка занимаемой памяти в байтах, включая служебные данные контейнеров
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<std::string_view> terms_;
+    // deque не переносит строки при росте, так что string_view на них остаются валидными
+    std::deque<std::string> owned_terms_;
+    std::unordered_map<std::string_view, TermId> ids_;
+};
\ No newline at end of file
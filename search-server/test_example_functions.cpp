@@ -1,10 +1,14 @@
 #include "test_example_functions.h"
 #include <iostream>
+#include <stdexcept>
 #include "search_server.h"
 #include "log_duration.h"
 #include "document.h"
 
-void AddDocument(SearchServer search_server,int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings) {
-    LOG_DURATION();
-    AddDocument(search_server, document_id, document, status, ratings);
+void AddDocument(SearchServer& search_server, int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings) {
+    try {
+        search_server.AddDocument(document_id, document, status, ratings);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Ошибка добавления документа "s << document_id << ": "s << e.what() << std::endl;
+    }
 }
\ No newline at end of file
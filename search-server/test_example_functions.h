@@ -5,4 +5,4 @@
 #include "log_duration.h"
 #include "document.h"
 
-void AddDocument(SearchServer search_server,int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings);
\ No newline at end of file
+void AddDocument(SearchServer& search_server, int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings);
\ No newline at end of file
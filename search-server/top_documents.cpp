@@ -0,0 +1,78 @@
+#include "top_documents.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "document.h"
+#include "instrumentation.h"
+
+TopDocuments::TopDocuments(size_t max_count)
+    : max_count_(max_count) {
+    heap_.reserve(std::min(max_count_, MAX_RESERVED_COUNT));
+}
+
+TopDocuments::TopDocuments(size_t max_count, const Document& after)
+    : TopDocuments(max_count) {
+    has_after_ = true;
+    after_ = after;
+}
+
+void TopDocuments::Add(const Document& document) {
+    if (max_count_ == 0 || (has_after_ && !IsBetter(after_, document))) {
+        return;
+    }
+    if (heap_.size() < max_count_) {
+        heap_.push_back(document);
+        std::push_heap(heap_.begin(), heap_.end(), IsBetter);
+    } else if (IsBetter(document, heap_.front())) {
+        std::pop_heap(heap_.begin(), heap_.end(), IsBetter);
+        heap_.back() = document;
+        std::push_heap(heap_.begin(), heap_.end(), IsBetter);
+    }
+}
+
+const Document& TopDocuments::GetWorst() const {
+    return heap_.front();
+}
+
+bool TopDocuments::IsFull() const {
+    return max_count_ > 0 && heap_.size() == max_count_;
+}
+
+size_t TopDocuments::GetMaxCount() const {
+    return max_count_;
+}
+
+size_t TopDocuments::GetCount() const {
+    return heap_.size();
+}
+
+std::vector<Document> TopDocuments::Extract() {
+    INSTRUMENT_STAGE(InstrumentationStage::SORT);
+    std::sort_heap(heap_.begin(), heap_.end(), IsBetter);
+    return std::move(heap_);
+}
+
+std::vector<Document> TopDocuments::ExtractTail(size_t count) {
+    INSTRUMENT_STAGE(InstrumentationStage::SORT);
+    count = std::min(count, heap_.size());
+    std::vector<Document> tail(count);
+    // На вершине кучи худший документ, поэтому хвост снимается с конца
+    for (size_t i = count; i > 0; --i) {
+        std::pop_heap(heap_.begin(), heap_.end(), IsBetter);
+        tail[i - 1] = heap_.back();
+        heap_.pop_back();
+    }
+    return tail;
+}
+
+bool TopDocuments::IsBetter(const Document& lhs, const Document& rhs) {
+    const double ALLOWABLE_ERROR = 1e-6;
+    if (std::abs(lhs.relevance - rhs.relevance) < ALLOWABLE_ERROR) {
+        if (lhs.rating == rhs.rating) {
+            return lhs.id < rhs.id;
+        }
+        return lhs.rating > rhs.rating;
+    } else {
+        return lhs.relevance > rhs.relevance;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "document.h"
+
+// Отбирает не больше max_count лучших документов из потока, не сохраняя остальные.
+// Внутри — куча, на вершине которой худший из отобранных документов
+class TopDocuments {
+public:
+    explicit TopDocuments(size_t max_count);
+
+    // Продолжение выдачи: отбираются только документы, которые в порядке IsBetter идут строго после after
+    TopDocuments(size_t max_count, const Document& after);
+
+    void Add(const Document& document);
+
+    // Порог отбора: документ, который не лучше него, уже не попадёт в результат.
+    // Имеет смысл только когда IsFull() == true
+    const Document& GetWorst() const;
+
+    bool IsFull() const;
+
+    size_t GetMaxCount() const;
+
+    size_t GetCount() const;
+
+    // Возвращает отобранные документы от лучшего к худшему
+    std::vector<Document> Extract();
+
+    // Возвращает count худших из отобранных от лучшего к худшему, не сортируя остальные
+    std::vector<Document> ExtractTail(size_t count);
+
+    // Релевантность сравнивается с точностью до 1e-6, при равной релевантности выше рейтинг,
+    // при равном рейтинге — меньший id, чтобы результат не зависел от порядка обхода
+    static bool IsBetter(const Document& lhs, const Document& rhs);
+
+private:
+    // Больше заранее не резервируем: max_count может быть равен размеру всего корпуса
+    static constexpr size_t MAX_RESERVED_COUNT = 64;
+
+    size_t max_count_;
+    std::vector<Document> heap_;
+    bool has_after_ = false;
+    Document after_;
+};
\ No newline at end of file